@@ -0,0 +1,19 @@
+# Microbenchmark of the transform compose kernels: glm::mat3 multiply per
+# node against the tagged per-kind kernels and the SIMD batch kernels.
+# Build and run with `qmake && make && ./affinebench`.
+QT -= core gui
+
+TARGET = affinebench
+TEMPLATE = app
+CONFIG += console
+CONFIG += c++1z
+CONFIG += release
+CONFIG -= app_bundle
+
+include(../../core/core.pri)
+
+SOURCES += main.cpp
+
+*-clang*|*-g++* {
+    QMAKE_CXXFLAGS += -Wall -Wextra
+}
@@ -0,0 +1,165 @@
+// Compose world = parent * local for every node of a synthetic tree, in
+// level order, with each of the available kernels. Prints one line per
+// kernel and tree size: "<kernel> <nodes> <ns per node>".
+#include "affinebatch.h"
+#include "transform2d.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// A tree stored level by level; every node's parent is on the level above.
+struct LevelTree
+{
+    std::vector<int> parent;
+    std::vector<int> levelStart;
+    std::vector<Transform2D> local;
+};
+
+static LevelTree MakeTree(int iNodes, int iFanout)
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> value(-2.f, 2.f);
+
+    LevelTree tree;
+    tree.parent.push_back(0);
+    tree.levelStart.push_back(0);
+    tree.levelStart.push_back(1);
+    while (static_cast<int>(tree.parent.size()) < iNodes)
+    {
+        int begin = tree.levelStart[tree.levelStart.size() - 2];
+        int end = tree.levelStart.back();
+        for (int p = begin; p < end && static_cast<int>(tree.parent.size()) < iNodes; p++)
+        {
+            for (int c = 0; c < iFanout && static_cast<int>(tree.parent.size()) < iNodes; c++)
+            {
+                tree.parent.push_back(p);
+            }
+        }
+        tree.levelStart.push_back(static_cast<int>(tree.parent.size()));
+    }
+
+    for (int i = 0; i < iNodes; i++)
+    {
+        switch (i % 3)
+        {
+            case 0:
+                tree.local.push_back(Transform2D::Translate(value(random), value(random)));
+                break;
+            case 1:
+                tree.local.push_back(Transform2D::Rotate(value(random) * 90.f));
+                break;
+            default:
+                tree.local.push_back(Transform2D::Scale(value(random), value(random)));
+                break;
+        }
+    }
+    return tree;
+}
+
+// Best of iRepeats, in nanoseconds per node.
+template<typename F>
+static double Measure(int iNodes, int iRepeats, F iPass)
+{
+    double best = 1e30;
+    for (int r = 0; r < iRepeats; r++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        iPass();
+        std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+        best = ns < best ? ns : best;
+    }
+    return best / iNodes;
+}
+
+int main(int argc, char** argv)
+{
+    int repeats = argc > 1 ? std::atoi(argv[1]) : 20;
+    const int sizes[] = {1024, 65536, 1048576};
+
+    std::printf("# best of %d passes, batch kernel picked at run time: %s\n",
+                repeats, GetAffineKernelName(GetBestAffineKernel()));
+    for (int s = 0; s < 3; s++)
+    {
+        int n = sizes[s];
+        LevelTree tree = MakeTree(n, 4);
+        int levels = static_cast<int>(tree.levelStart.size()) - 1;
+        float checksum = 0.f;
+
+        // Plain glm: build the local mat3 and multiply, as TraversalDraw did.
+        std::vector<glm::mat3> localMat(n);
+        std::vector<glm::mat3> worldMat(n);
+        for (int i = 0; i < n; i++)
+        {
+            localMat[i] = tree.local[i].ToMat3();
+        }
+        double glmTime = Measure(n, repeats, [&]
+        {
+            worldMat[0] = localMat[0];
+            for (int i = 1; i < n; i++)
+            {
+                worldMat[i] = worldMat[tree.parent[i]] * localMat[i];
+            }
+        });
+        checksum += worldMat[n - 1][2][0];
+        std::printf("glm-mat3 %d %.3f\n", n, glmTime);
+
+        // The tagged per-kind kernels of the incremental Propagate().
+        std::vector<Affine2x3> worldAffine(n);
+        double taggedTime = Measure(n, repeats, [&]
+        {
+            worldAffine[0] = tree.local[0].ToAffine();
+            for (int i = 1; i < n; i++)
+            {
+                ComposeTransform(worldAffine[tree.parent[i]], tree.local[i], worldAffine[i]);
+            }
+        });
+        checksum += worldAffine[n - 1].m[4];
+        std::printf("tagged %d %.3f\n", n, taggedTime);
+
+        // The batch kernels on level-ordered structure-of-arrays data.
+        std::vector<float> local[6];
+        std::vector<float> world[6];
+        AffineArrays localArrays;
+        AffineArrays worldArrays;
+        for (int c = 0; c < 6; c++)
+        {
+            local[c].resize(n);
+            world[c].resize(n);
+            for (int i = 0; i < n; i++)
+            {
+                local[c][i] = tree.local[i].ToAffine().m[c];
+            }
+            localArrays.m[c] = local[c].data();
+            worldArrays.m[c] = world[c].data();
+        }
+        for (int k = 0; k < AFFINE_KERNEL_COUNT; k++)
+        {
+            AffineBatchKernel kernel = GetAffineBatchKernel(k);
+            if (kernel == nullptr)
+            {
+                std::printf("# %s not supported here\n", GetAffineKernelName(k));
+                continue;
+            }
+            double batchTime = Measure(n, repeats, [&]
+            {
+                for (int c = 0; c < 6; c++)
+                {
+                    world[c][0] = local[c][0];
+                }
+                for (int d = 1; d < levels; d++)
+                {
+                    kernel(worldArrays, localArrays, tree.parent.data(), tree.levelStart[d], tree.levelStart[d + 1]);
+                }
+            });
+            checksum += world[4][n - 1];
+            std::printf("batch-%s %d %.3f\n", GetAffineKernelName(k), n, batchTime);
+        }
+        // Printed so the passes cannot be optimized away.
+        std::printf("# checksum %g\n", checksum);
+    }
+    return 0;
+}
@@ -0,0 +1,3 @@
+# Every benchmark; `qmake bench/bench.pro && make` builds them all.
+TEMPLATE = subdirs
+SUBDIRS = affine scene
@@ -0,0 +1,456 @@
+// Benchmarks of the scene-graph core on synthetic scenes: N-ary trees, deep
+// chains and crowds of robots (robotscene.h). For every scene it times
+//   create           building the scene into a fresh NodePool
+//   walk-transforms  TraversalDraw's recursive GetWorldTransformation() walk after the root moved
+//   propagate-full   TransformHierarchy::Propagate() after the root moved
+//   propagate-batch  PropagateBatch(), level by level with the best SIMD kernel, after the root moved
+//   propagate-edit   the same after a node at the bottom moved
+//   propagate-parallel-<t>  PropagateParallel() on t threads after the root moved, for t = 1, 2, 4, ...
+//                    up to the thread count
+//   find-walk        finding a node by a recursive search, as TraversalFind did
+//   find-handle      finding it through NodePool::Get()
+//   drawlist-walk    queueing the shapes from the recursive walk and sorting them
+//   drawlist-flat    the same from the compiled hierarchy's draw order
+//   cull-full        recomputing every bounding box and culling the draw order to the view
+//   index-build      building a SpatialIndex over the shapes' world bounds
+//   index-refit      refitting it after a translation with about 1% of the entries below it moved
+//   index-rebuild    SpatialIndex::Update() after the root moved, which rebuilds
+//   index-point      shapes at a random point of the scene
+//   index-rect       shapes intersecting a random 2x2 square
+//   index-nearest    the NEAREST_COUNT shapes nearest to a random point
+// Prints one line per scene and operation: "<scene> <nodes> <operation> <ns> <per>",
+// the best of the passes in nanoseconds per node, per lookup or per pass, as
+// the last column says. Needs no display; run with
+// `./scenebench [passes] [grain] [threads]`: grain is PropagateParallel()'s
+// entries per task, 4096 by default, and threads the most it runs on, by
+// default every hardware thread.
+//
+// For reference, best of 5 on one thread, ns/node after the root moved:
+//   scene        walk-transforms  propagate-full
+//   tree2 1M     24.4             11.0
+//   tree16 1.1M  21.7             11.5
+//   robots 258k  28.8             12.4
+#include "nodepool.h"
+#include "renderqueue.h"
+#include "robotscene.h"
+#include "spatialindex.h"
+#include "taskpool.h"
+#include "transformhierarchy.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+// Nodes looked up by the find-* operations; find-handle repeats them
+// FIND_ROUNDS times to get above the clock's resolution.
+static const int FIND_TARGETS = 16;
+static const int FIND_ROUNDS = 1000;
+// Random points, and squares around them, asked of the spatial index.
+static const int QUERY_POINTS = 1000;
+static const int NEAREST_COUNT = 8;
+
+typedef TranslateNode& (*SceneBuilder)(NodePool& ioPool, int iSize, int iFanout);
+
+struct SceneSpec
+{
+    const char* name;
+    SceneBuilder build;
+    int size;   // Nodes, or robots for the crowds
+    int fanout; // Children per node of the N-ary trees
+};
+
+// Node kinds cycle T, R, S; every other node carries a shape, so the draw
+// lists hold about half of the nodes.
+static Node& CreateNode(NodePool& ioPool, int iIndex, std::mt19937& ioRandom)
+{
+    std::uniform_real_distribution<float> value(-1.f, 1.f);
+    char name[24];
+    std::snprintf(name, sizeof(name), "n%d", iIndex);
+    Node* node;
+    switch (iIndex % 3)
+    {
+        case 0:
+            node = &ioPool.CreateTranslate(value(ioRandom), value(ioRandom), name);
+            break;
+        case 1:
+            node = &ioPool.CreateRotate(value(ioRandom) * 90.f, name);
+            break;
+        default:
+            node = &ioPool.CreateScale(1.f + 0.1f * value(ioRandom), 1.f + 0.1f * value(ioRandom), name);
+            break;
+    }
+    if (iIndex % 2 == 1)
+    {
+        node->AddGeo(GEO_RECTANGLE + GeometryId(iIndex / 2 % 4));
+        node->ModifyColor(glm::vec3(0.5f + 0.5f * value(ioRandom), 0.5f, 0.5f));
+    }
+    return *node;
+}
+
+// Complete tree of iSize nodes, filled level by level.
+static TranslateNode& BuildTree(NodePool& ioPool, int iSize, int iFanout)
+{
+    std::mt19937 random(1234);
+    TranslateNode& root = ioPool.CreateTranslate(0.f, 0.f, "root");
+    std::vector<Node*> nodes;
+    nodes.reserve(iSize);
+    nodes.push_back(&root);
+    for (int i = 1; i < iSize; i++)
+    {
+        nodes.push_back(&nodes[(i - 1) / iFanout]->AddChild(CreateNode(ioPool, i, random)));
+    }
+    return root;
+}
+
+// iSize nodes, each the only child of the one before.
+static TranslateNode& BuildChain(NodePool& ioPool, int iSize, int)
+{
+    std::mt19937 random(1234);
+    TranslateNode& root = ioPool.CreateTranslate(0.f, 0.f, "root");
+    Node* last = &root;
+    for (int i = 1; i < iSize; i++)
+    {
+        last = &last->AddChild(CreateNode(ioPool, i, random));
+    }
+    return root;
+}
+
+// iSize robots standing on a square grid.
+static TranslateNode& BuildCrowd(NodePool& ioPool, int iSize, int)
+{
+    TranslateNode& root = ioPool.CreateTranslate(0.f, 0.f, "root");
+    int side = 1;
+    while (side * side < iSize)
+    {
+        side++;
+    }
+    for (int i = 0; i < iSize; i++)
+    {
+        Node& place = root.AddChild(ioPool.CreateTranslate(4.f * (i % side), 8.f * (i / side), "robot T"));
+        place.AddChild(BuildRobotScene(ioPool));
+    }
+    return root;
+}
+
+// Best of iPasses in nanoseconds, divided by iItems. iSetup runs before
+// every pass and is not timed.
+template<typename S, typename F>
+static double Measure(int iItems, int iPasses, S iSetup, F iPass)
+{
+    double best = 1e30;
+    for (int r = 0; r < iPasses; r++)
+    {
+        iSetup();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        iPass();
+        std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+        best = ns < best ? ns : best;
+    }
+    return best / iItems;
+}
+
+static void NoSetup()
+{}
+
+static void ListNodes(Node* iNodePtr, std::vector<Node*>& oNodes)
+{
+    oNodes.push_back(iNodePtr);
+    for (Node* p = iNodePtr->GetFirstChild(); p != nullptr; p = p->GetNextSibling())
+    {
+        ListNodes(p, oNodes);
+    }
+}
+
+static float WalkTransforms(Node* iNodePtr)
+{
+    float sum = iNodePtr->GetWorldTransformation().m[4];
+    for (Node* p = iNodePtr->GetFirstChild(); p != nullptr; p = p->GetNextSibling())
+    {
+        sum += WalkTransforms(p);
+    }
+    return sum;
+}
+
+static Node* FindWalk(Node* iNodePtr, NodeHandle iTarget)
+{
+    if (iNodePtr->GetHandle() == iTarget)
+    {
+        return iNodePtr;
+    }
+    for (Node* p = iNodePtr->GetFirstChild(); p != nullptr; p = p->GetNextSibling())
+    {
+        Node* found = FindWalk(p, iTarget);
+        if (found != nullptr)
+        {
+            return found;
+        }
+    }
+    return nullptr;
+}
+
+// The keys SceneRenderer::QueueDraw() pushes: one layer, one program, the
+// shape, and the position in the walk.
+static void QueueWalk(Node* iNodePtr, RenderQueue& ioQueue)
+{
+    for (Node* p = iNodePtr->GetFirstChild(); p != nullptr; p = p->GetNextSibling())
+    {
+        QueueWalk(p, ioQueue);
+    }
+    if (iNodePtr->GetGeoId() != GEO_NONE)
+    {
+        iNodePtr->GetWorldTransformation();
+        std::uint32_t item = std::uint32_t(ioQueue.GetPackets().size());
+        ioQueue.Push(RenderQueue::MakeKey(1, 0, iNodePtr->GetGeoId(), item), item);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int passes = argc > 1 ? std::atoi(argv[1]) : 10;
+    int grain = argc > 2 ? std::atoi(argv[2]) : 4096;
+    int maxThreads = argc > 3 ? std::atoi(argv[3]) : 0;
+    const SceneSpec scenes[] = {
+        {"tree2", BuildTree, 65535, 2},
+        {"tree2", BuildTree, 1048575, 2},
+        {"tree16", BuildTree, 69905, 16},
+        {"tree16", BuildTree, 1118481, 16},
+        {"chain", BuildChain, 1024, 1},
+        {"chain", BuildChain, 16384, 1},
+        {"robots", BuildCrowd, 64, 1},
+        {"robots", BuildCrowd, 4096, 1},
+    };
+    TaskPool taskPool(maxThreads);
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < taskPool.GetThreadCount(); threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(taskPool.GetThreadCount());
+    float checksum = 0.f;
+
+    std::printf("# best of %d passes, up to %d propagation threads, grain %d\n", passes, taskPool.GetThreadCount(),
+                grain);
+    std::printf("# scene nodes operation ns per\n");
+    for (const SceneSpec& spec : scenes)
+    {
+        // Every pass builds into a fresh pool; tearing down the last one is not timed.
+        uPtr<NodePool> pool;
+        TranslateNode* root = nullptr;
+        double createTime = Measure(1, passes, [&] { pool = mkU<NodePool>(); },
+                                    [&] { root = &spec.build(*pool, spec.size, spec.fanout); });
+        std::vector<Node*> nodes;
+        ListNodes(root, nodes);
+        int n = static_cast<int>(nodes.size());
+        std::printf("%s %d create %.3f node\n", spec.name, n, createTime / n);
+
+        // Moving the root dirties every world transform; that marking is set-up, not timed.
+        float x = 0.f;
+        std::function<void()> moveRoot = [&] { root->SetXTranslation(x += 0.25f); };
+        double walkTime = Measure(n, passes, moveRoot, [&] { checksum += WalkTransforms(root); });
+        std::printf("%s %d walk-transforms %.3f node\n", spec.name, n, walkTime);
+
+        // Unfused, so the hierarchy has one entry per node.
+        TransformHierarchy hierarchy;
+        hierarchy.Compile(*root);
+        double fullTime = Measure(n, passes, moveRoot, [&] { hierarchy.Propagate(); });
+        checksum += hierarchy.worldMat.back().m[4];
+        std::printf("%s %d propagate-full %.3f node\n", spec.name, n, fullTime);
+        double batchTime = Measure(n, passes, moveRoot, [&] { hierarchy.PropagateBatch(); });
+        checksum += hierarchy.worldMat.back().m[4];
+        std::printf("%s %d propagate-batch %.3f node\n", spec.name, n, batchTime);
+
+        // The last translation in pre-order is at the bottom of the tree.
+        TranslateNode* edited = root;
+        for (Node* node : nodes)
+        {
+            if (node->GetNodeType() == 1)
+            {
+                edited = static_cast<TranslateNode*>(node);
+            }
+        }
+        // It alternates between its own y and 0.25 above, and is put back after.
+        const float editedY = edited->GetYTranslation();
+        bool raised = false;
+        hierarchy.Propagate();
+        double editTime = Measure(1, passes, [&]
+        {
+            raised = !raised;
+            edited->SetYTranslation(raised ? editedY + 0.25f : editedY);
+        }, [&] { hierarchy.Propagate(); });
+        edited->SetYTranslation(editedY);
+        std::printf("%s %d propagate-edit %.3f pass\n", spec.name, n, editTime);
+
+        for (int threads : threadCounts)
+        {
+            taskPool.SetThreadCount(threads);
+            double parallelTime = Measure(n, passes, moveRoot, [&] { hierarchy.PropagateParallel(taskPool, grain); });
+            checksum += hierarchy.worldMat.back().m[4];
+            std::printf("%s %d propagate-parallel-%d %.3f node\n", spec.name, n, threads, parallelTime);
+        }
+
+        // The same random nodes for both kinds of lookup.
+        std::mt19937 random(5678);
+        std::uniform_int_distribution<int> pick(0, n - 1);
+        std::vector<NodeHandle> targets;
+        for (int i = 0; i < FIND_TARGETS; i++)
+        {
+            targets.push_back(nodes[pick(random)]->GetHandle());
+        }
+        int found = 0;
+        double walkFindTime = Measure(FIND_TARGETS, passes, NoSetup, [&]
+        {
+            for (NodeHandle target : targets)
+            {
+                found += FindWalk(root, target) != nullptr;
+            }
+        });
+        std::printf("%s %d find-walk %.3f lookup\n", spec.name, n, walkFindTime);
+        double handleFindTime = Measure(FIND_TARGETS * FIND_ROUNDS, passes, NoSetup, [&]
+        {
+            for (int r = 0; r < FIND_ROUNDS; r++)
+            {
+                for (NodeHandle target : targets)
+                {
+                    found += pool->Get(target) != nullptr;
+                }
+            }
+        });
+        std::printf("%s %d find-handle %.3f lookup\n", spec.name, n, handleFindTime);
+        checksum += float(found);
+
+        RenderQueue queue;
+        double walkListTime = Measure(n, passes, [&] { queue.Clear(); }, [&]
+        {
+            QueueWalk(root, queue);
+            queue.Sort();
+        });
+        std::printf("%s %d drawlist-walk %.3f node\n", spec.name, n, walkListTime);
+        const std::vector<int>& drawOrder = hierarchy.GetDrawOrder();
+        double flatListTime = Measure(n, passes, [&] { queue.Clear(); }, [&]
+        {
+            std::uint32_t item = 0;
+            for (int i : drawOrder)
+            {
+                queue.Push(RenderQueue::MakeKey(1, 0, hierarchy.geoId[i], item), item);
+                item++;
+            }
+            queue.Sort();
+        });
+        checksum += float(queue.GetPackets().size());
+        std::printf("%s %d drawlist-flat %.3f node\n", spec.name, n, flatListTime);
+
+        // Bounds of every entry after the root moved, then the walk that skips
+        // whatever lies outside the -5 to 5 view SceneRenderer shows. The other
+        // operations push the root ever further right; here it alternates
+        // between x 0 and 0.25, so what is in view does not depend on the
+        // passes or on the operations before, and is counted at x 0.
+        const Aabb2 view = Aabb2::FromMinMax(-5.f, -5.f, 5.f, 5.f);
+        std::vector<int> visible;
+        int skipped = 0;
+        bool shifted = false;
+        std::function<void()> placeRoot = [&]
+        {
+            shifted = !shifted;
+            root->SetXTranslation(shifted ? 0.25f : 0.f);
+            hierarchy.Propagate();
+        };
+        double cullTime = Measure(n, passes, placeRoot, [&]
+        {
+            hierarchy.UpdateBounds();
+            skipped = hierarchy.CullDrawOrder(view, visible);
+        });
+        std::printf("%s %d cull-full %.3f node\n", spec.name, n, cullTime);
+        root->SetXTranslation(0.f);
+        hierarchy.Propagate();
+        hierarchy.UpdateBounds();
+        skipped = hierarchy.CullDrawOrder(view, visible);
+        std::printf("# %s %d: %zu of %zu shapes in view at x 0, %d subtrees skipped\n", spec.name, n,
+                    visible.size(), drawOrder.size(), skipped);
+
+        int shapes = static_cast<int>(drawOrder.size());
+        SpatialIndex index;
+        double buildTime = Measure(shapes, passes, NoSetup, [&] { index.Build(hierarchy.geoBounds, drawOrder); });
+        std::printf("%s %d index-build %.3f shape\n", spec.name, n, buildTime);
+
+        // The translation whose subtree is nearest to 1% of the entries; entry i
+        // is nodes[i] because the hierarchy is not fused.
+        int movedEntry = 0;
+        for (int i = 0; i < n; i++)
+        {
+            int target = n / 100;
+            if (nodes[i]->GetNodeType() == 1 &&
+                std::abs(hierarchy.subtreeSize[i] - target) < std::abs(hierarchy.subtreeSize[movedEntry] - target))
+            {
+                movedEntry = i;
+            }
+        }
+        TranslateNode* moved = static_cast<TranslateNode*>(nodes[movedEntry]);
+        double refitTime = Measure(1, passes, [&]
+        {
+            moved->SetXTranslation(x += 0.25f);
+            hierarchy.Propagate();
+            hierarchy.UpdateBounds();
+        }, [&] { index.Refit(hierarchy.geoBounds, hierarchy.GetMovedShapes()); });
+        std::printf("%s %d index-refit %.3f pass\n", spec.name, n, refitTime);
+        std::printf("# %s %d: refit %zu of %d shapes, cost %.3g after refits, %.3g when built\n", spec.name, n,
+                    hierarchy.GetMovedShapes().size(), shapes, index.GetStats().cost, index.GetStats().builtCost);
+
+        bool rebuilt = true;
+        double rebuildTime = Measure(shapes, passes, [&]
+        {
+            moveRoot();
+            hierarchy.Propagate();
+            hierarchy.UpdateBounds();
+        }, [&] { rebuilt &= index.Update(hierarchy.geoBounds, hierarchy.GetMovedShapes()); });
+        std::printf("%s %d index-rebuild %.3f shape\n", spec.name, n, rebuildTime);
+        if (!rebuilt)
+        {
+            std::printf("# %s %d: Update() refitted instead of rebuilding\n", spec.name, n);
+        }
+
+        const Aabb2& sceneBounds = hierarchy.subtreeBounds[0];
+        std::uniform_real_distribution<float> across(0.f, 1.f);
+        std::vector<glm::vec2> points;
+        for (int i = 0; i < QUERY_POINTS; i++)
+        {
+            points.push_back(glm::mix(sceneBounds.min, sceneBounds.max, glm::vec2(across(random), across(random))));
+        }
+        std::vector<int> hits;
+        size_t hitCount = 0;
+        double pointTime = Measure(QUERY_POINTS, passes, NoSetup, [&]
+        {
+            for (glm::vec2 p : points)
+            {
+                index.QueryPoint(p, hits);
+                hitCount += hits.size();
+            }
+        });
+        std::printf("%s %d index-point %.3f lookup\n", spec.name, n, pointTime);
+        double rectTime = Measure(QUERY_POINTS, passes, NoSetup, [&]
+        {
+            for (glm::vec2 p : points)
+            {
+                index.QueryRect(Aabb2{p - glm::vec2(1.f), p + glm::vec2(1.f)}, hits);
+                hitCount += hits.size();
+            }
+        });
+        std::printf("%s %d index-rect %.3f lookup\n", spec.name, n, rectTime);
+        double nearestTime = Measure(QUERY_POINTS, passes, NoSetup, [&]
+        {
+            for (glm::vec2 p : points)
+            {
+                index.QueryNearest(p, NEAREST_COUNT, hits);
+                hitCount += hits.size();
+            }
+        });
+        std::printf("%s %d index-nearest %.3f lookup\n", spec.name, n, nearestTime);
+        checksum += float(hitCount);
+    }
+    // Printed so the passes cannot be optimized away.
+    std::printf("# checksum %g\n", checksum);
+    return 0;
+}
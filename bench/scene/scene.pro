@@ -0,0 +1,21 @@
+# Benchmarks of the scene-graph core on generated scenes: N-ary trees, deep
+# chains and robot crowds. Times node creation, transform propagation, node
+# lookup and draw-list construction; needs no display.
+# Build and run with `qmake && make && ./scenebench`.
+QT -= core gui
+
+TARGET = scenebench
+TEMPLATE = app
+CONFIG += console
+CONFIG += c++1z
+CONFIG += release
+CONFIG += thread
+CONFIG -= app_bundle
+
+include(../../core/core.pri)
+
+SOURCES += main.cpp
+
+*-clang*|*-g++* {
+    QMAKE_CXXFLAGS += -Wall -Wextra
+}
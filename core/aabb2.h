@@ -0,0 +1,58 @@
+#pragma once
+#include "affine2x3.h"
+#include <cmath>
+
+// An axis-aligned box in the plane. Empty boxes have min > max, so they
+// intersect nothing and vanish in a union.
+struct Aabb2
+{
+    glm::vec2 min;
+    glm::vec2 max;
+
+    static Aabb2 Empty()
+    {
+        Aabb2 b = {glm::vec2(1e30f), glm::vec2(-1e30f)};
+        return b;
+    }
+
+    static Aabb2 FromMinMax(float iMinX, float iMinY, float iMaxX, float iMaxY)
+    {
+        Aabb2 b = {glm::vec2(iMinX, iMinY), glm::vec2(iMaxX, iMaxY)};
+        return b;
+    }
+
+    bool IsEmpty() const
+    {
+        return min.x > max.x || min.y > max.y;
+    }
+
+    bool Intersects(const Aabb2& iOther) const
+    {
+        return min.x <= iOther.max.x && iOther.min.x <= max.x &&
+               min.y <= iOther.max.y && iOther.min.y <= max.y;
+    }
+
+    void Include(const Aabb2& iOther)
+    {
+        min = glm::min(min, iOther.min);
+        max = glm::max(max, iOther.max);
+    }
+};
+
+// The box around iBox after iTransform. Each output extent is the center
+// moved by iTransform plus the box's half extents weighted by the absolute
+// matrix entries, so no corners are transformed.
+inline Aabb2 TransformBounds(const Aabb2& iBox, const Affine2x3& iTransform)
+{
+    if (iBox.IsEmpty())
+    {
+        return iBox;
+    }
+    const float* m = iTransform.m;
+    glm::vec2 c = (iBox.min + iBox.max) * 0.5f;
+    glm::vec2 h = (iBox.max - iBox.min) * 0.5f;
+    glm::vec2 center(m[0] * c.x + m[2] * c.y + m[4], m[1] * c.x + m[3] * c.y + m[5]);
+    glm::vec2 half(std::abs(m[0]) * h.x + std::abs(m[2]) * h.y, std::abs(m[1]) * h.x + std::abs(m[3]) * h.y);
+    Aabb2 b = {center - half, center + half};
+    return b;
+}
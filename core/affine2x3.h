@@ -0,0 +1,45 @@
+#pragma once
+#include "coremath.h"
+
+// A 2D affine transformation stored as the upper two rows of a mat3,
+// column by column (the layout of a GLSL mat3x2):
+//   | m[0] m[2] m[4] |
+//   | m[1] m[3] m[5] |
+//   |  0    0    1   |
+struct Affine2x3
+{
+    float m[6];
+
+    static Affine2x3 Identity()
+    {
+        Affine2x3 a = {{1.f, 0.f, 0.f, 1.f, 0.f, 0.f}};
+        return a;
+    }
+
+    static Affine2x3 FromMat3(const glm::mat3& iMat)
+    {
+        Affine2x3 a = {{iMat[0][0], iMat[0][1], iMat[1][0], iMat[1][1], iMat[2][0], iMat[2][1]}};
+        return a;
+    }
+
+    glm::mat3 ToMat3() const
+    {
+        return glm::mat3(m[0], m[1], 0.f,
+                         m[2], m[3], 0.f,
+                         m[4], m[5], 1.f);
+    }
+};
+
+// oResult = iParent * iLocal. Same operation order as the batch kernels, so
+// both give bit-identical results. oResult must not alias iParent.
+inline void ComposeAffine(const Affine2x3& iParent, const Affine2x3& iLocal, Affine2x3& oResult)
+{
+    const float* p = iParent.m;
+    const float* l = iLocal.m;
+    oResult.m[0] = p[0] * l[0] + p[2] * l[1];
+    oResult.m[1] = p[1] * l[0] + p[3] * l[1];
+    oResult.m[2] = p[0] * l[2] + p[2] * l[3];
+    oResult.m[3] = p[1] * l[2] + p[3] * l[3];
+    oResult.m[4] = p[0] * l[4] + p[2] * l[5] + p[4];
+    oResult.m[5] = p[1] * l[4] + p[3] * l[5] + p[5];
+}
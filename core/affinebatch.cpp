@@ -0,0 +1,184 @@
+#include "affinebatch.h"
+
+// The SSE2 kernel is built whenever glm's setup detected SSE2 (always the case
+// on x86-64). The AVX2 kernel is built for x86 with GCC/Clang, through a target
+// attribute, or MSVC; whether it runs is decided at run time.
+#if (GLM_ARCH & GLM_ARCH_SSE2) || defined(_M_X64)
+#define AFFINE_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) || (defined(_MSC_VER) && defined(_M_X64))
+#define AFFINE_HAS_AVX2 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AFFINE_TARGET_AVX2
+#else
+#define AFFINE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// One entry; also the tail of the vector kernels.
+static inline void ComposeAffineEntry(const AffineArrays& ioWorld, const AffineArrays& iLocal, int iParent, int k)
+{
+    float* const* w = ioWorld.m;
+    float* const* l = iLocal.m;
+    float a = w[0][iParent], b = w[1][iParent], c = w[2][iParent];
+    float d = w[3][iParent], e = w[4][iParent], f = w[5][iParent];
+    w[0][k] = a * l[0][k] + c * l[1][k];
+    w[1][k] = b * l[0][k] + d * l[1][k];
+    w[2][k] = a * l[2][k] + c * l[3][k];
+    w[3][k] = b * l[2][k] + d * l[3][k];
+    w[4][k] = a * l[4][k] + c * l[5][k] + e;
+    w[5][k] = b * l[4][k] + d * l[5][k] + f;
+}
+
+static void ComposeAffineBatchScalar(const AffineArrays& ioWorld, const AffineArrays& iLocal,
+                                     const int* iParent, int iBegin, int iEnd)
+{
+    for (int k = iBegin; k < iEnd; k++)
+    {
+        ComposeAffineEntry(ioWorld, iLocal, iParent[k], k);
+    }
+}
+
+#ifdef AFFINE_HAS_SSE2
+static void ComposeAffineBatchSSE2(const AffineArrays& ioWorld, const AffineArrays& iLocal,
+                                   const int* iParent, int iBegin, int iEnd)
+{
+    float* const* w = ioWorld.m;
+    float* const* l = iLocal.m;
+    int k = iBegin;
+    for (; k + 4 <= iEnd; k += 4)
+    {
+        // SSE2 has no gather: the parents' components are picked up one by one.
+        int p0 = iParent[k], p1 = iParent[k + 1], p2 = iParent[k + 2], p3 = iParent[k + 3];
+        __m128 a = _mm_set_ps(w[0][p3], w[0][p2], w[0][p1], w[0][p0]);
+        __m128 b = _mm_set_ps(w[1][p3], w[1][p2], w[1][p1], w[1][p0]);
+        __m128 c = _mm_set_ps(w[2][p3], w[2][p2], w[2][p1], w[2][p0]);
+        __m128 d = _mm_set_ps(w[3][p3], w[3][p2], w[3][p1], w[3][p0]);
+        __m128 e = _mm_set_ps(w[4][p3], w[4][p2], w[4][p1], w[4][p0]);
+        __m128 f = _mm_set_ps(w[5][p3], w[5][p2], w[5][p1], w[5][p0]);
+        __m128 l0 = _mm_loadu_ps(l[0] + k);
+        __m128 l1 = _mm_loadu_ps(l[1] + k);
+        __m128 l2 = _mm_loadu_ps(l[2] + k);
+        __m128 l3 = _mm_loadu_ps(l[3] + k);
+        __m128 l4 = _mm_loadu_ps(l[4] + k);
+        __m128 l5 = _mm_loadu_ps(l[5] + k);
+        _mm_storeu_ps(w[0] + k, _mm_add_ps(_mm_mul_ps(a, l0), _mm_mul_ps(c, l1)));
+        _mm_storeu_ps(w[1] + k, _mm_add_ps(_mm_mul_ps(b, l0), _mm_mul_ps(d, l1)));
+        _mm_storeu_ps(w[2] + k, _mm_add_ps(_mm_mul_ps(a, l2), _mm_mul_ps(c, l3)));
+        _mm_storeu_ps(w[3] + k, _mm_add_ps(_mm_mul_ps(b, l2), _mm_mul_ps(d, l3)));
+        _mm_storeu_ps(w[4] + k, _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, l4), _mm_mul_ps(c, l5)), e));
+        _mm_storeu_ps(w[5] + k, _mm_add_ps(_mm_add_ps(_mm_mul_ps(b, l4), _mm_mul_ps(d, l5)), f));
+    }
+    for (; k < iEnd; k++)
+    {
+        ComposeAffineEntry(ioWorld, iLocal, iParent[k], k);
+    }
+}
+#endif
+
+#ifdef AFFINE_HAS_AVX2
+// Built without FMA on purpose: a fused multiply-add rounds differently from
+// the scalar kernel, and all kernels have to agree bit for bit.
+AFFINE_TARGET_AVX2
+static void ComposeAffineBatchAVX2(const AffineArrays& ioWorld, const AffineArrays& iLocal,
+                                   const int* iParent, int iBegin, int iEnd)
+{
+    float* const* w = ioWorld.m;
+    float* const* l = iLocal.m;
+    int k = iBegin;
+    for (; k + 8 <= iEnd; k += 8)
+    {
+        __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(iParent + k));
+        __m256 a = _mm256_i32gather_ps(w[0], p, 4);
+        __m256 b = _mm256_i32gather_ps(w[1], p, 4);
+        __m256 c = _mm256_i32gather_ps(w[2], p, 4);
+        __m256 d = _mm256_i32gather_ps(w[3], p, 4);
+        __m256 e = _mm256_i32gather_ps(w[4], p, 4);
+        __m256 f = _mm256_i32gather_ps(w[5], p, 4);
+        __m256 l0 = _mm256_loadu_ps(l[0] + k);
+        __m256 l1 = _mm256_loadu_ps(l[1] + k);
+        __m256 l2 = _mm256_loadu_ps(l[2] + k);
+        __m256 l3 = _mm256_loadu_ps(l[3] + k);
+        __m256 l4 = _mm256_loadu_ps(l[4] + k);
+        __m256 l5 = _mm256_loadu_ps(l[5] + k);
+        _mm256_storeu_ps(w[0] + k, _mm256_add_ps(_mm256_mul_ps(a, l0), _mm256_mul_ps(c, l1)));
+        _mm256_storeu_ps(w[1] + k, _mm256_add_ps(_mm256_mul_ps(b, l0), _mm256_mul_ps(d, l1)));
+        _mm256_storeu_ps(w[2] + k, _mm256_add_ps(_mm256_mul_ps(a, l2), _mm256_mul_ps(c, l3)));
+        _mm256_storeu_ps(w[3] + k, _mm256_add_ps(_mm256_mul_ps(b, l2), _mm256_mul_ps(d, l3)));
+        _mm256_storeu_ps(w[4] + k, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, l4), _mm256_mul_ps(c, l5)), e));
+        _mm256_storeu_ps(w[5] + k, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b, l4), _mm256_mul_ps(d, l5)), f));
+    }
+    for (; k < iEnd; k++)
+    {
+        ComposeAffineEntry(ioWorld, iLocal, iParent[k], k);
+    }
+}
+
+static bool CpuHasAVX2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+AffineBatchKernel GetAffineBatchKernel(int iKernel)
+{
+    switch (iKernel)
+    {
+        case AFFINE_KERNEL_SCALAR:
+            return &ComposeAffineBatchScalar;
+#ifdef AFFINE_HAS_SSE2
+        case AFFINE_KERNEL_SSE2:
+            return &ComposeAffineBatchSSE2;
+#endif
+#ifdef AFFINE_HAS_AVX2
+        case AFFINE_KERNEL_AVX2:
+            return CpuHasAVX2() ? &ComposeAffineBatchAVX2 : nullptr;
+#endif
+    }
+    return nullptr;
+}
+
+int GetBestAffineKernel()
+{
+    static const int best = []
+    {
+        int kernel = AFFINE_KERNEL_COUNT - 1;
+        while (kernel > AFFINE_KERNEL_SCALAR && GetAffineBatchKernel(kernel) == nullptr)
+        {
+            kernel--;
+        }
+        return kernel;
+    }();
+    return best;
+}
+
+const char* GetAffineKernelName(int iKernel)
+{
+    switch (iKernel)
+    {
+        case AFFINE_KERNEL_SCALAR:
+            return "scalar";
+        case AFFINE_KERNEL_SSE2:
+            return "sse2";
+        case AFFINE_KERNEL_AVX2:
+            return "avx2";
+    }
+    return "unknown";
+}
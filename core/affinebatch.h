@@ -0,0 +1,27 @@
+#pragma once
+#include "affine2x3.h"
+
+// Structure-of-arrays form of Affine2x3: component c of entry k is m[c][k].
+struct AffineArrays
+{
+    float* m[6];
+};
+
+// Batch compose: ioWorld[k] = ioWorld[iParent[k]] * iLocal[k] for k in [iBegin, iEnd).
+// Every parent must lie outside [iBegin, iEnd), e.g. all entries of one tree level.
+// All kernels use the same operation order as ComposeAffine(), so their results
+// are bit-identical.
+typedef void (*AffineBatchKernel)(const AffineArrays& ioWorld, const AffineArrays& iLocal,
+                                  const int* iParent, int iBegin, int iEnd);
+
+// Instruction sets a batch kernel can be built for.
+const int AFFINE_KERNEL_SCALAR = 0;
+const int AFFINE_KERNEL_SSE2 = 1;   // 4 entries per step
+const int AFFINE_KERNEL_AVX2 = 2;   // 8 entries per step, parents fetched with gathers
+const int AFFINE_KERNEL_COUNT = 3;
+
+// The kernel for iKernel, or nullptr if this build or this CPU cannot run it.
+AffineBatchKernel GetAffineBatchKernel(int iKernel);
+// The best kernel the CPU supports, detected once at the first call.
+int GetBestAffineKernel();
+const char* GetAffineKernelName(int iKernel);
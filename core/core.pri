@@ -0,0 +1,43 @@
+# The scene-graph core: hierarchy, transforms and geometry references.
+# Nothing in here may depend on Qt, so it can be built and benchmarked
+# on machines without a display.
+INCLUDEPATH += $$PWD
+INCLUDEPATH += $$PWD/../include
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/affinebatch.cpp \
+    $$PWD/frameprofiler.cpp \
+    $$PWD/jsonreader.cpp \
+    $$PWD/mappedfile.cpp \
+    $$PWD/node.cpp \
+    $$PWD/nodepool.cpp \
+    $$PWD/renderqueue.cpp \
+    $$PWD/robotscene.cpp \
+    $$PWD/scenefile.cpp \
+    $$PWD/sceneio.cpp \
+    $$PWD/scenetext.cpp \
+    $$PWD/spatialindex.cpp \
+    $$PWD/taskpool.cpp \
+    $$PWD/transformhierarchy.cpp
+
+HEADERS += \
+    $$PWD/aabb2.h \
+    $$PWD/affine2x3.h \
+    $$PWD/affinebatch.h \
+    $$PWD/frameprofiler.h \
+    $$PWD/jsonreader.h \
+    $$PWD/mappedfile.h \
+    $$PWD/coremath.h \
+    $$PWD/node.h \
+    $$PWD/nodepool.h \
+    $$PWD/renderqueue.h \
+    $$PWD/robotscene.h \
+    $$PWD/scenefile.h \
+    $$PWD/sceneio.h \
+    $$PWD/scenetext.h \
+    $$PWD/spatialindex.h \
+    $$PWD/taskpool.h \
+    $$PWD/transform2d.h \
+    $$PWD/transformhierarchy.h \
+    $$PWD/smartpointerhelp.h
@@ -0,0 +1,18 @@
+# Headless static library of the scene-graph core.
+# Build it on its own with `qmake core/core.pro && make`; the SceneGraph
+# application compiles the same sources through core.pri.
+QT -= core gui
+
+TARGET = sceneGraphCore
+TEMPLATE = lib
+CONFIG += staticlib
+CONFIG += c++1z
+CONFIG += warn_on
+
+include(core.pri)
+
+*-clang*|*-g++* {
+    CONFIG -= warn_on
+    QMAKE_CXXFLAGS += -Wall -Wextra -pedantic -Winit-self
+    QMAKE_CXXFLAGS += -Wno-strict-aliasing
+}
@@ -0,0 +1,215 @@
+#include "frameprofiler.h"
+
+#include <cstring>
+
+FrameProfiler::FrameProfiler()
+    : enabled(false), deferredTimer(nullptr), frameNumber(0),
+      summaryFrames(0), dumpFile(nullptr)
+{
+    current.number = 0;
+    current.deferredPending = 0;
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    StopDump();
+}
+
+void FrameProfiler::SetEnabled(bool iEnabled)
+{
+    if (iEnabled == enabled)
+    {
+        return;
+    }
+    enabled = iEnabled;
+    // Whatever was recorded so far is incomplete; readings still in flight
+    // find no frame and are dropped.
+    current.samples.clear();
+    current.deferredPending = 0;
+    openScopes.clear();
+    pending.clear();
+    summarySum.clear();
+    summaryFrames = 0;
+}
+
+bool FrameProfiler::IsEnabled() const
+{
+    return enabled;
+}
+
+void FrameProfiler::SetDeferredTimer(DeferredTimer* iTimer)
+{
+    deferredTimer = iTimer;
+}
+
+int FrameProfiler::BeginScope(const char* iName, ProfileClock iClock)
+{
+    if (!enabled)
+    {
+        return -1;
+    }
+    int sample = static_cast<int>(current.samples.size());
+    ProfileSample s = {iName, static_cast<int>(openScopes.size()), -1.0, -1.0};
+    current.samples.push_back(s);
+
+    OpenScope scope = {sample, Clock::time_point(), iClock == PROFILE_CPU_GPU && deferredTimer != nullptr};
+    if (scope.deferred)
+    {
+        current.deferredPending++;
+        deferredTimer->Begin(current.number, sample);
+    }
+    // Started last, so the timer's own work is not part of the scope.
+    scope.start = Clock::now();
+    openScopes.push_back(scope);
+    return sample;
+}
+
+void FrameProfiler::EndScope(int iSample)
+{
+    // A scope that began before the profiler was switched on or off has nothing to end.
+    if (iSample < 0 || openScopes.empty() || openScopes.back().sample != iSample)
+    {
+        return;
+    }
+    const OpenScope& scope = openScopes.back();
+    current.samples[iSample].cpuMs = std::chrono::duration<double, std::milli>(Clock::now() - scope.start).count();
+    if (scope.deferred)
+    {
+        deferredTimer->End(current.number, iSample);
+    }
+    openScopes.pop_back();
+}
+
+void FrameProfiler::EndFrame()
+{
+    if (!enabled)
+    {
+        return;
+    }
+    // Scopes still open belong to no frame.
+    openScopes.clear();
+    pending.push_back(std::move(current));
+    current.number = ++frameNumber;
+    current.samples.clear();
+    current.deferredPending = 0;
+
+    if (deferredTimer != nullptr)
+    {
+        deferredTimer->Collect(*this);
+    }
+    RetirePending();
+}
+
+void FrameProfiler::SetDeferredTime(unsigned iFrame, int iSample, double iMs)
+{
+    Frame* frame = FindPending(iFrame);
+    if (frame == nullptr || iSample < 0 || iSample >= static_cast<int>(frame->samples.size()))
+    {
+        return;
+    }
+    frame->samples[iSample].gpuMs = iMs;
+    frame->deferredPending--;
+}
+
+FrameProfiler::Frame* FrameProfiler::FindPending(unsigned iFrame)
+{
+    for (std::deque<Frame>::iterator p = pending.begin(); p != pending.end(); p++)
+    {
+        if (p->number == iFrame)
+        {
+            return &*p;
+        }
+    }
+    return nullptr;
+}
+
+void FrameProfiler::RetirePending()
+{
+    // Frames finish in order, so the summary and the dump see them in order too.
+    while (!pending.empty() &&
+           (pending.front().deferredPending <= 0 || frameNumber - pending.front().number > MAX_GPU_LATENCY))
+    {
+        Finish(pending.front());
+        pending.pop_front();
+    }
+}
+
+void FrameProfiler::Finish(const Frame& iFrame)
+{
+    if (dumpFile != nullptr)
+    {
+        for (std::vector<ProfileSample>::const_iterator s = iFrame.samples.begin(); s != iFrame.samples.end(); s++)
+        {
+            std::fprintf(dumpFile, "%u,%d,%s,%.4f,", iFrame.number, s->depth, s->name, s->cpuMs);
+            if (s->gpuMs >= 0.0)
+            {
+                std::fprintf(dumpFile, "%.4f", s->gpuMs);
+            }
+            std::fputc('\n', dumpFile);
+        }
+    }
+
+    // Scopes are matched by name and depth. One that ran several times in a
+    // frame, or only in some, is summed, so the summary is time per frame.
+    for (std::vector<ProfileSample>::const_iterator s = iFrame.samples.begin(); s != iFrame.samples.end(); s++)
+    {
+        std::vector<ProfileSample>::iterator sum = summarySum.begin();
+        while (sum != summarySum.end() && (sum->depth != s->depth || std::strcmp(sum->name, s->name) != 0))
+        {
+            sum++;
+        }
+        if (sum == summarySum.end())
+        {
+            ProfileSample zero = {s->name, s->depth, 0.0, -1.0};
+            sum = summarySum.insert(summarySum.end(), zero);
+        }
+        sum->cpuMs += s->cpuMs;
+        if (s->gpuMs >= 0.0)
+        {
+            sum->gpuMs = (sum->gpuMs < 0.0 ? 0.0 : sum->gpuMs) + s->gpuMs;
+        }
+    }
+    if (++summaryFrames == SUMMARY_FRAMES)
+    {
+        summary.swap(summarySum);
+        for (std::vector<ProfileSample>::iterator s = summary.begin(); s != summary.end(); s++)
+        {
+            s->cpuMs /= SUMMARY_FRAMES;
+            s->gpuMs = s->gpuMs < 0.0 ? -1.0 : s->gpuMs / SUMMARY_FRAMES;
+        }
+        summarySum.clear();
+        summaryFrames = 0;
+    }
+}
+
+const std::vector<ProfileSample>& FrameProfiler::GetSummary() const
+{
+    return summary;
+}
+
+bool FrameProfiler::StartDump(const char* iPath, std::string& oError)
+{
+    StopDump();
+    dumpFile = std::fopen(iPath, "w");
+    if (dumpFile == nullptr)
+    {
+        oError = std::string("cannot open ") + iPath + " for writing";
+        return false;
+    }
+    std::fputs("frame,depth,scope,cpu_ms,gpu_ms\n", dumpFile);
+    return true;
+}
+
+void FrameProfiler::StopDump()
+{
+    if (dumpFile != nullptr)
+    {
+        std::fclose(dumpFile);
+        dumpFile = nullptr;
+    }
+}
+
+bool FrameProfiler::IsDumping() const
+{
+    return dumpFile != nullptr;
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+class FrameProfiler;
+
+// Which clocks time a scope. The GPU can only time scopes that issue GL
+// commands while a context is current.
+enum ProfileClock
+{
+    PROFILE_CPU,
+    PROFILE_CPU_GPU
+};
+
+// One timed scope of a frame. Times are -1 when that clock did not time it.
+struct ProfileSample
+{
+    const char* name; // A string literal at the scope; also the key of the summary.
+    int depth;        // Number of scopes the sample is nested in.
+    double cpuMs;
+    double gpuMs;
+};
+
+// Times scopes on a clock whose readings arrive frames later, such as GL
+// timer queries. FrameProfiler keeps a frame open until its readings are in.
+class DeferredTimer
+{
+public:
+    virtual ~DeferredTimer() {}
+    // Start and stop timing sample iSample of frame iFrame.
+    virtual void Begin(unsigned iFrame, int iSample) = 0;
+    virtual void End(unsigned iFrame, int iSample) = 0;
+    // Pass every reading that has arrived to ioProfiler.SetDeferredTime(),
+    // without waiting for the ones that have not.
+    virtual void Collect(FrameProfiler& ioProfiler) = 0;
+};
+
+// Named, nested CPU scopes per frame, optionally paired with GPU times from a
+// DeferredTimer. Finished frames are averaged into a summary for display and,
+// while a dump is open, written to a CSV file for offline comparison.
+// Disabled, a scope costs one branch.
+class FrameProfiler
+{
+public:
+    // Frames whose GPU times are not in after this many frames are finished without them.
+    static const unsigned MAX_GPU_LATENCY = 8;
+    // Frames averaged into one summary.
+    static const unsigned SUMMARY_FRAMES = 30;
+
+    FrameProfiler();
+    ~FrameProfiler();
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    void SetEnabled(bool iEnabled);
+    bool IsEnabled() const;
+    // The timer for PROFILE_CPU_GPU scopes; nullptr times them on the CPU only.
+    void SetDeferredTimer(DeferredTimer* iTimer);
+
+    // Scopes between two EndFrame() calls belong to one frame; those of UI
+    // handlers between frames count towards the frame drawn after them.
+    // Returns the sample index, or -1 while disabled.
+    int BeginScope(const char* iName, ProfileClock iClock = PROFILE_CPU);
+    void EndScope(int iSample);
+    // Close the current frame and collect the deferred times that have arrived.
+    void EndFrame();
+    // Called by the DeferredTimer for a sample it was asked to time.
+    void SetDeferredTime(unsigned iFrame, int iSample, double iMs);
+
+    // Averages of the last SUMMARY_FRAMES finished frames, one entry per scope
+    // in the order of the frame's samples; empty until that many are finished.
+    const std::vector<ProfileSample>& GetSummary() const;
+
+    // Write every frame finished from now on to iPath as
+    // "frame,depth,scope,cpu_ms,gpu_ms" lines. False with oError if it cannot be opened.
+    bool StartDump(const char* iPath, std::string& oError);
+    void StopDump();
+    bool IsDumping() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Frame
+    {
+        unsigned number;
+        std::vector<ProfileSample> samples;
+        int deferredPending; // Deferred times that have not arrived yet
+    };
+
+    struct OpenScope
+    {
+        int sample;
+        Clock::time_point start;
+        bool deferred;
+    };
+
+    Frame* FindPending(unsigned iFrame);
+    // Finish the oldest pending frames that have all their times or waited long enough.
+    void RetirePending();
+    void Finish(const Frame& iFrame);
+
+    bool enabled;
+    DeferredTimer* deferredTimer;
+    unsigned frameNumber;
+    Frame current;
+    std::vector<OpenScope> openScopes;
+    std::deque<Frame> pending; // Closed frames still waiting for deferred times, oldest first.
+
+    std::vector<ProfileSample> summarySum; // Sums over the frames finished since the last summary
+    unsigned summaryFrames;
+    std::vector<ProfileSample> summary;
+
+    FILE* dumpFile;
+};
+
+// Times the enclosing block as a scope of iProfiler.
+class ProfileScope
+{
+public:
+    ProfileScope(FrameProfiler& ioProfiler, const char* iName, ProfileClock iClock = PROFILE_CPU)
+        : profiler(ioProfiler), sample(ioProfiler.BeginScope(iName, iClock))
+    {}
+    ~ProfileScope()
+    {
+        profiler.EndScope(sample);
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    FrameProfiler& profiler;
+    int sample;
+};
@@ -0,0 +1,506 @@
+#include "jsonreader.h"
+#include <cmath>
+
+static const size_t JSON_BUFFER_SIZE = 256 * 1024;
+// Exactly representable, so scaling by them rounds only once.
+static const double POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const int MAX_TABLE_EXPONENT = 22;
+
+JsonReader::JsonReader(FILE* iFile)
+    : file(iFile), buffer(JSON_BUFFER_SIZE), position(0), available(0), bytesRead(0),
+      line(1), column(1), expect(EXPECT_VALUE), number(0.0), boolean(false)
+{}
+
+bool JsonReader::Refill()
+{
+    position = 0;
+    available = std::fread(buffer.data(), 1, buffer.size(), file);
+    bytesRead += available;
+    return available > 0;
+}
+
+int JsonReader::Peek()
+{
+    if (position == available && !Refill())
+    {
+        return EOF;
+    }
+    return static_cast<unsigned char>(buffer[position]);
+}
+
+int JsonReader::Get()
+{
+    int c = Peek();
+    if (c == EOF)
+    {
+        return EOF;
+    }
+    position++;
+    if (c == '\n')
+    {
+        line++;
+        column = 1;
+    }
+    else
+    {
+        column++;
+    }
+    return c;
+}
+
+void JsonReader::SkipWhitespace()
+{
+    // Straight over the buffer; indentation is most of a pretty-printed file.
+    while (position < available || Refill())
+    {
+        char c = buffer[position];
+        if (c == '\n')
+        {
+            line++;
+            column = 1;
+        }
+        else if (c == ' ' || c == '\t' || c == '\r')
+        {
+            column++;
+        }
+        else
+        {
+            return;
+        }
+        position++;
+    }
+}
+
+JsonEvent JsonReader::Fail(const char* iMessage)
+{
+    error = std::to_string(line) + ":" + std::to_string(column) + ": " + iMessage;
+    return JSON_ERROR;
+}
+
+void JsonReader::ValueDone()
+{
+    expect = containers.empty() ? EXPECT_NOTHING : EXPECT_COMMA_OR_END;
+}
+
+JsonEvent JsonReader::Next()
+{
+    if (!error.empty())
+    {
+        return JSON_ERROR;
+    }
+
+    SkipWhitespace();
+    int c = Peek();
+    bool inObject = !containers.empty() && containers.back() == '{';
+
+    switch (expect)
+    {
+        case EXPECT_NOTHING:
+            return c == EOF ? JSON_END : Fail("unexpected data after the document");
+
+        case EXPECT_COLON:
+            if (c != ':')
+            {
+                return Fail("expected ':'");
+            }
+            Get();
+            expect = EXPECT_VALUE;
+            return Next();
+
+        case EXPECT_COMMA_OR_END:
+            if (c == ',')
+            {
+                Get();
+                expect = inObject ? EXPECT_KEY : EXPECT_VALUE;
+                return Next();
+            }
+            if (c == (inObject ? '}' : ']'))
+            {
+                Get();
+                containers.pop_back();
+                ValueDone();
+                return inObject ? JSON_END_OBJECT : JSON_END_ARRAY;
+            }
+            return Fail(inObject ? "expected ',' or '}'" : "expected ',' or ']'");
+
+        case EXPECT_KEY_OR_END:
+        case EXPECT_KEY:
+            if (c == '}' && expect == EXPECT_KEY_OR_END)
+            {
+                Get();
+                containers.pop_back();
+                ValueDone();
+                return JSON_END_OBJECT;
+            }
+            if (c != '"')
+            {
+                return Fail("expected a key");
+            }
+            if (!ReadString())
+            {
+                return JSON_ERROR;
+            }
+            expect = EXPECT_COLON;
+            return JSON_KEY;
+
+        case EXPECT_VALUE_OR_END:
+            if (c == ']')
+            {
+                Get();
+                containers.pop_back();
+                ValueDone();
+                return JSON_END_ARRAY;
+            }
+            break;
+
+        case EXPECT_VALUE:
+            break;
+    }
+
+    // A value.
+    switch (c)
+    {
+        case '{':
+            Get();
+            containers.push_back('{');
+            expect = EXPECT_KEY_OR_END;
+            return JSON_BEGIN_OBJECT;
+        case '[':
+            Get();
+            containers.push_back('[');
+            expect = EXPECT_VALUE_OR_END;
+            return JSON_BEGIN_ARRAY;
+        case '"':
+            if (!ReadString())
+            {
+                return JSON_ERROR;
+            }
+            ValueDone();
+            return JSON_STRING;
+        case 't':
+            if (!ReadLiteral("true"))
+            {
+                return JSON_ERROR;
+            }
+            boolean = true;
+            ValueDone();
+            return JSON_BOOL;
+        case 'f':
+            if (!ReadLiteral("false"))
+            {
+                return JSON_ERROR;
+            }
+            boolean = false;
+            ValueDone();
+            return JSON_BOOL;
+        case 'n':
+            if (!ReadLiteral("null"))
+            {
+                return JSON_ERROR;
+            }
+            ValueDone();
+            return JSON_NULL;
+        case EOF:
+            return Fail("unexpected end of file");
+    }
+    if (c == '-' || (c >= '0' && c <= '9'))
+    {
+        if (!ReadNumber())
+        {
+            return JSON_ERROR;
+        }
+        ValueDone();
+        return JSON_NUMBER;
+    }
+    return Fail("expected a value");
+}
+
+bool JsonReader::ReadLiteral(const char* iRest)
+{
+    for (const char* p = iRest; *p != '\0'; p++)
+    {
+        if (Get() != *p)
+        {
+            Fail("invalid literal");
+            return false;
+        }
+    }
+    return true;
+}
+
+static void AppendUtf8(std::string& ioText, unsigned int iCode)
+{
+    if (iCode < 0x80)
+    {
+        ioText += static_cast<char>(iCode);
+    }
+    else if (iCode < 0x800)
+    {
+        ioText += static_cast<char>(0xc0 | (iCode >> 6));
+        ioText += static_cast<char>(0x80 | (iCode & 0x3f));
+    }
+    else if (iCode < 0x10000)
+    {
+        ioText += static_cast<char>(0xe0 | (iCode >> 12));
+        ioText += static_cast<char>(0x80 | ((iCode >> 6) & 0x3f));
+        ioText += static_cast<char>(0x80 | (iCode & 0x3f));
+    }
+    else
+    {
+        ioText += static_cast<char>(0xf0 | (iCode >> 18));
+        ioText += static_cast<char>(0x80 | ((iCode >> 12) & 0x3f));
+        ioText += static_cast<char>(0x80 | ((iCode >> 6) & 0x3f));
+        ioText += static_cast<char>(0x80 | (iCode & 0x3f));
+    }
+}
+
+bool JsonReader::ReadHex4(unsigned int& oCode)
+{
+    oCode = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        int h = Get();
+        int digit = h >= '0' && h <= '9' ? h - '0' :
+                    h >= 'a' && h <= 'f' ? h - 'a' + 10 :
+                    h >= 'A' && h <= 'F' ? h - 'A' + 10 : -1;
+        if (digit < 0)
+        {
+            Fail("invalid \\u escape");
+            return false;
+        }
+        oCode = oCode * 16 + static_cast<unsigned int>(digit);
+    }
+    return true;
+}
+
+bool JsonReader::ReadString()
+{
+    Get(); // The opening quote.
+    text.clear();
+    while (true)
+    {
+        // Append the run of plain characters in the buffer at once.
+        size_t start = position;
+        while (position < available)
+        {
+            unsigned char u = static_cast<unsigned char>(buffer[position]);
+            if (u == '"' || u == '\\' || u < 0x20)
+            {
+                break;
+            }
+            position++;
+        }
+        text.append(buffer.data() + start, position - start);
+        column += static_cast<unsigned int>(position - start);
+
+        int c = Get();
+        if (c == '"')
+        {
+            return true;
+        }
+        if (c == EOF || c < 0x20)
+        {
+            Fail(c == EOF ? "unterminated string" : "control character in string");
+            return false;
+        }
+        if (c != '\\')
+        {
+            text += static_cast<char>(c); // The run ended at the end of the buffer.
+            continue;
+        }
+
+        c = Get();
+        switch (c)
+        {
+            case '"': text += '"'; break;
+            case '\\': text += '\\'; break;
+            case '/': text += '/'; break;
+            case 'b': text += '\b'; break;
+            case 'f': text += '\f'; break;
+            case 'n': text += '\n'; break;
+            case 'r': text += '\r'; break;
+            case 't': text += '\t'; break;
+            case 'u':
+            {
+                unsigned int code = 0;
+                if (!ReadHex4(code))
+                {
+                    return false;
+                }
+                // A high surrogate has to be followed by a low one, and the
+                // pair encodes one code point. Alone, either is invalid.
+                if (code >= 0xdc00 && code < 0xe000)
+                {
+                    Fail("unpaired low surrogate");
+                    return false;
+                }
+                if (code >= 0xd800 && code < 0xdc00)
+                {
+                    if (Get() != '\\' || Get() != 'u')
+                    {
+                        Fail("unpaired high surrogate");
+                        return false;
+                    }
+                    unsigned int low = 0;
+                    if (!ReadHex4(low))
+                    {
+                        return false;
+                    }
+                    if (low < 0xdc00 || low >= 0xe000)
+                    {
+                        Fail("invalid surrogate pair");
+                        return false;
+                    }
+                    code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                }
+                AppendUtf8(text, code);
+                break;
+            }
+            default:
+                Fail("invalid escape");
+                return false;
+        }
+    }
+}
+
+static bool IsDigit(int iChar)
+{
+    return iChar >= '0' && iChar <= '9';
+}
+
+bool JsonReader::ReadNumber()
+{
+    // Up to 19 significant digits go into an integer mantissa, the rest only
+    // shift the exponent. Plenty for values that end up as floats.
+    bool negative = false;
+    if (Peek() == '-')
+    {
+        Get();
+        negative = true;
+    }
+    unsigned long long mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    if (Peek() == '0')
+    {
+        // A zero integer part is just "0"; JSON has no octal or padded numbers.
+        Get();
+        any = true;
+        if (IsDigit(Peek()))
+        {
+            Fail("leading zero in number");
+            return false;
+        }
+    }
+    while (IsDigit(Peek()))
+    {
+        int d = Get() - '0';
+        any = true;
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + static_cast<unsigned long long>(d);
+            digits += mantissa != 0;
+        }
+        else
+        {
+            exponent++;
+        }
+    }
+    if (Peek() == '.')
+    {
+        Get();
+        bool fraction = false;
+        while (IsDigit(Peek()))
+        {
+            int d = Get() - '0';
+            fraction = true;
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + static_cast<unsigned long long>(d);
+                digits += mantissa != 0;
+                exponent--;
+            }
+        }
+        if (!fraction)
+        {
+            Fail("expected digits after '.'");
+            return false;
+        }
+    }
+    if (!any)
+    {
+        Fail("expected digits");
+        return false;
+    }
+    if (Peek() == 'e' || Peek() == 'E')
+    {
+        Get();
+        bool negativeExponent = false;
+        if (Peek() == '+' || Peek() == '-')
+        {
+            negativeExponent = Get() == '-';
+        }
+        if (!IsDigit(Peek()))
+        {
+            Fail("expected exponent digits");
+            return false;
+        }
+        int e = 0;
+        while (IsDigit(Peek()))
+        {
+            int d = Get() - '0';
+            if (e < 10000)
+            {
+                e = e * 10 + d;
+            }
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+
+    number = static_cast<double>(mantissa);
+    if (exponent != 0 && mantissa != 0)
+    {
+        int magnitude = exponent > 0 ? exponent : -exponent;
+        double scale = magnitude <= MAX_TABLE_EXPONENT ? POWERS_OF_TEN[magnitude] : std::pow(10.0, magnitude);
+        number = exponent > 0 ? number * scale : number / scale;
+    }
+    if (!std::isfinite(number))
+    {
+        Fail("number out of range");
+        return false;
+    }
+    if (negative)
+    {
+        number = -number;
+    }
+    return true;
+}
+
+const std::string& JsonReader::GetString() const
+{
+    return text;
+}
+
+double JsonReader::GetNumber() const
+{
+    return number;
+}
+
+bool JsonReader::GetBool() const
+{
+    return boolean;
+}
+
+const std::string& JsonReader::GetError() const
+{
+    return error;
+}
+
+unsigned long long JsonReader::GetBytesRead() const
+{
+    return bytesRead;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// What JsonReader::Next() found.
+enum JsonEvent
+{
+    JSON_BEGIN_OBJECT,
+    JSON_END_OBJECT,
+    JSON_BEGIN_ARRAY,
+    JSON_END_ARRAY,
+    JSON_KEY,       // GetString() holds the key
+    JSON_STRING,    // GetString() holds the value
+    JSON_NUMBER,    // GetNumber() holds the value
+    JSON_BOOL,      // GetBool() holds the value
+    JSON_NULL,
+    JSON_END,       // The document is complete
+    JSON_ERROR      // GetError() says what and where
+};
+
+// A streaming (pull) JSON reader. It reads the file through a fixed buffer and
+// never builds a document; memory stays bounded by the buffer, the nesting
+// depth and the longest string. Nesting is tracked on an explicit stack, so
+// deep documents cannot overflow the call stack. Numbers are parsed without
+// the C locale, which Qt sets to the user's.
+class JsonReader
+{
+public:
+    // iFile stays owned by the caller.
+    explicit JsonReader(FILE* iFile);
+
+    JsonEvent Next();
+
+    const std::string& GetString() const;
+    double GetNumber() const;
+    bool GetBool() const;
+
+    // "line:column: message" for the last JSON_ERROR, or an error set through Fail().
+    const std::string& GetError() const;
+    // Report a semantic error at the current position; returns JSON_ERROR.
+    JsonEvent Fail(const char* iMessage);
+    unsigned long long GetBytesRead() const;
+
+private:
+    // Where the grammar is inside the innermost container.
+    enum Expect
+    {
+        EXPECT_VALUE,           // top level, after ':' or after ',' in an array
+        EXPECT_VALUE_OR_END,    // after '['
+        EXPECT_KEY,             // after ',' in an object
+        EXPECT_KEY_OR_END,      // after '{'
+        EXPECT_COLON,
+        EXPECT_COMMA_OR_END,
+        EXPECT_NOTHING          // the top-level value is complete
+    };
+
+    int Peek();
+    int Get();
+    bool Refill();
+    void SkipWhitespace();
+    bool ReadString();
+    bool ReadHex4(unsigned int& oCode);
+    bool ReadNumber();
+    bool ReadLiteral(const char* iRest);
+    // A value was read: update what comes next.
+    void ValueDone();
+
+    FILE* file;
+    std::vector<char> buffer;
+    size_t position;
+    size_t available;
+    unsigned long long bytesRead;
+    unsigned int line;
+    unsigned int column;
+
+    std::vector<char> containers;   // '{' or '[' for every open container
+    Expect expect;
+
+    std::string text;
+    double number;
+    bool boolean;
+    std::string error;
+};
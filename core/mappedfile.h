@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+
+// A read-only memory mapping of a whole file. Pages are only read from disk
+// when they are first touched.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map iPath, replacing any earlier mapping. Returns false if the file
+    // cannot be opened or mapped; empty files cannot be mapped either.
+    bool Open(const char* iPath);
+    void Close();
+
+    const unsigned char* GetData() const;
+    size_t GetSize() const;
+
+private:
+    const unsigned char* data;
+    size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
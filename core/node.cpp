@@ -0,0 +1,302 @@
+#include "node.h"
+#include "transformhierarchy.h"
+
+const Aabb2& GetGeometryBounds(GeometryId iGeoId)
+{
+    static const Aabb2 bounds[GEO_COUNT] = {
+        Aabb2::Empty(),                              // GEO_NONE
+        Aabb2::FromMinMax(-0.5f, -0.5f, 0.5f, 0.5f), // GEO_RECTANGLE
+        Aabb2::FromMinMax(-0.5f, -0.5f, 0.5f, 0.5f), // GEO_CIRCLE, radius 0.5
+        Aabb2::FromMinMax(-1.f, -0.5f, 1.f, 0.5f),   // GEO_TRAPEZOID
+        Aabb2::FromMinMax(-1.f, -1.f, 1.f, 1.f),     // GEO_SHOE
+    };
+    return iGeoId < GEO_COUNT ? bounds[iGeoId] : bounds[GEO_NONE];
+}
+
+Node& Node::AddChild(Node& iChild)
+{
+    iChild.parentPtr = this;
+    iChild.nextSiblingPtr = nullptr;
+    if (lastChildPtr != nullptr)
+    {
+        lastChildPtr->nextSiblingPtr = &iChild;
+    }
+    else
+    {
+        firstChildPtr = &iChild;
+    }
+    lastChildPtr = &iChild;
+
+    iChild.MarkWorldDirty();
+    MarkBoundsDirty();
+    if (hierarchyPtr != nullptr)
+    {
+        // The structure changed, the hierarchy has to be compiled again.
+        hierarchyPtr->Invalidate();
+    }
+    return iChild;
+}
+
+void Node::RemoveChild(Node& iChild)
+{
+    Node* previous = nullptr;
+    Node* p = firstChildPtr;
+    while (p != nullptr && p != &iChild)
+    {
+        previous = p;
+        p = p->nextSiblingPtr;
+    }
+    if (p == nullptr)
+    {
+        return;
+    }
+
+    if (previous != nullptr)
+    {
+        previous->nextSiblingPtr = iChild.nextSiblingPtr;
+    }
+    else
+    {
+        firstChildPtr = iChild.nextSiblingPtr;
+    }
+    if (lastChildPtr == &iChild)
+    {
+        lastChildPtr = previous;
+    }
+    iChild.parentPtr = nullptr;
+    iChild.nextSiblingPtr = nullptr;
+    iChild.MarkWorldDirty();
+    MarkBoundsDirty();
+
+    if (hierarchyPtr != nullptr)
+    {
+        hierarchyPtr->Invalidate();
+    }
+}
+
+Node* Node::GetFirstChild()
+{
+    return firstChildPtr;
+}
+
+Node* Node::GetNextSibling()
+{
+    return nextSiblingPtr;
+}
+
+const Transform2D& Node::GetLocalTransformation()
+{
+    return localTransform;
+}
+
+const Affine2x3& Node::GetWorldTransformation()
+{
+    if (worldDirty)
+    {
+        if (parentPtr != nullptr)
+        {
+            ComposeTransform(parentPtr->GetWorldTransformation(), localTransform, worldMat);
+        }
+        else
+        {
+            worldMat = localTransform.ToAffine();
+        }
+        worldDirty = false;
+    }
+    return worldMat;
+}
+
+const Aabb2& Node::GetGeometryWorldBounds()
+{
+    GetSubtreeBounds();
+    return geoBounds;
+}
+
+const Aabb2& Node::GetSubtreeBounds()
+{
+    if (boundsDirty)
+    {
+        geoBounds = TransformBounds(GetGeometryBounds(geoId), GetWorldTransformation());
+        subtreeBounds = geoBounds;
+        for (Node* p = firstChildPtr; p != nullptr; p = p->nextSiblingPtr)
+        {
+            subtreeBounds.Include(p->GetSubtreeBounds());
+        }
+        boundsDirty = false;
+    }
+    return subtreeBounds;
+}
+
+void Node::BindToHierarchy(TransformHierarchy* iHierarchyPtr, int iIndex)
+{
+    hierarchyPtr = iHierarchyPtr;
+    hierarchyIndex = iIndex;
+}
+
+void Node::SetLocalTransformation(const Transform2D& iLocal)
+{
+    localTransform = iLocal;
+    MarkWorldDirty();
+    if (parentPtr != nullptr)
+    {
+        parentPtr->MarkBoundsDirty();
+    }
+    if (hierarchyPtr != nullptr)
+    {
+        hierarchyPtr->SetLocalTransformation(hierarchyIndex, localTransform);
+    }
+}
+
+void Node::MarkWorldDirty()
+{
+    // A clean node always has clean ancestors, so once we reach a node that is
+    // already dirty its whole subtree is dirty as well and we can stop here.
+    if (worldDirty)
+    {
+        return;
+    }
+    worldDirty = true;
+    // Bounds are only computed from a clean world matrix, so a node whose
+    // world matrix is dirty already has dirty bounds as well.
+    boundsDirty = true;
+    for (Node* p = firstChildPtr; p != nullptr; p = p->nextSiblingPtr)
+    {
+        p->MarkWorldDirty();
+    }
+}
+
+void Node::MarkBoundsDirty()
+{
+    for (Node* p = this; p != nullptr && !p->boundsDirty; p = p->parentPtr)
+    {
+        p->boundsDirty = true;
+    }
+}
+
+void Node::ModifyColor(glm::vec3 iColor)
+{
+    this->color = iColor;
+    // Only nodes with geometry own the color of their entry; folded nodes share it.
+    if (hierarchyPtr != nullptr && geoId != GEO_NONE)
+    {
+        hierarchyPtr->SetColor(hierarchyIndex, this->color);
+    }
+}
+
+GeometryId Node::GetGeoId()
+{
+    return this->geoId;
+}
+
+void Node::AddGeo(GeometryId iGeoId)
+{
+    geoId = iGeoId;
+    MarkBoundsDirty();
+    if (hierarchyPtr != nullptr)
+    {
+        hierarchyPtr->Invalidate();
+    }
+}
+
+glm::vec3 Node::GetColor()
+{
+    return this->color;
+}
+
+const char* Node::GetName()
+{
+    return nodeName;
+}
+
+Node* Node::GetParent()
+{
+    return parentPtr;
+}
+
+unsigned Node::GetNodeType()
+{
+    return this->nodeType;
+}
+
+NodeHandle Node::GetHandle()
+{
+    return this->handle;
+}
+
+TranslateNode::TranslateNode(float ix, float iy, const char* iNodeName) : Node(iNodeName)
+{
+    this->nodeType = 1;
+    xTranslation = ix;
+    yTranslation = iy;
+    localTransform = Transform2D::Translate(xTranslation, yTranslation);
+}
+
+float TranslateNode::GetXTranslation()
+{
+    return xTranslation;
+}
+
+float TranslateNode::GetYTranslation()
+{
+    return yTranslation;
+}
+
+void TranslateNode::SetXTranslation(float i)
+{
+    xTranslation = i;
+    SetLocalTransformation(Transform2D::Translate(xTranslation, yTranslation));
+}
+
+void TranslateNode::SetYTranslation(float i)
+{
+    yTranslation = i;
+    SetLocalTransformation(Transform2D::Translate(xTranslation, yTranslation));
+}
+
+RotateNode::RotateNode(float imagnitude, const char* iNodeName) : Node(iNodeName)
+{
+    this->nodeType = 2;
+    magnitude = imagnitude;
+    localTransform = Transform2D::Rotate(magnitude);
+}
+
+float RotateNode::GetMagnitude()
+{
+    return magnitude;
+}
+
+void RotateNode::SetMagnitude(float i)
+{
+    magnitude = i;
+    SetLocalTransformation(Transform2D::Rotate(magnitude));
+}
+
+ScaleNode::ScaleNode(float ixScalar, float iyScalar, const char* iNodeName) : Node(iNodeName)
+{
+    this->nodeType = 3;
+    xScalar = ixScalar;
+    yScalar = iyScalar;
+    localTransform = Transform2D::Scale(xScalar, yScalar);
+}
+
+float ScaleNode::GetXScalar()
+{
+    return xScalar;
+}
+
+float ScaleNode::GetYScalar()
+{
+    return yScalar;
+}
+
+void ScaleNode::SetXScalar(float i)
+{
+    xScalar = i;
+    SetLocalTransformation(Transform2D::Scale(xScalar, yScalar));
+}
+
+void ScaleNode::SetYScalar(float i)
+{
+    yScalar = i;
+    SetLocalTransformation(Transform2D::Scale(xScalar, yScalar));
+}
@@ -0,0 +1,151 @@
+#ifndef NODE_H
+#define NODE_H
+#include "smartpointerhelp.h"
+#include "coremath.h"
+#include "aabb2.h"
+#include "transform2d.h"
+
+class TransformHierarchy;
+class NodePool;
+
+// Identifies a node inside its NodePool: the node type, a generation that
+// tells reused slots apart, and the slot in that type's slab.
+typedef unsigned int NodeHandle;
+const NodeHandle INVALID_NODE_HANDLE = 0xffffffffu;
+
+// Geometry is referenced by id. The renderer owns the actual Polygon2D objects
+// and maps each id to one of them, so the scene graph itself needs no OpenGL.
+typedef unsigned int GeometryId;
+const GeometryId GEO_NONE = 0;
+const GeometryId GEO_RECTANGLE = 1;
+const GeometryId GEO_CIRCLE = 2;
+const GeometryId GEO_TRAPEZOID = 3;
+const GeometryId GEO_SHOE = 4;
+const GeometryId GEO_COUNT = 5;
+
+// The local bounds of each geometry id's shape, as the renderer builds it
+// (see src/scene/polygon.cpp); empty for GEO_NONE and unknown ids.
+const Aabb2& GetGeometryBounds(GeometryId iGeoId);
+
+// Nodes are created by a NodePool, which owns them and their names.
+class Node
+{
+    friend class NodePool;
+public:
+    // iNodeName has to outlive the node; NodePool interns it for us.
+    Node(const char* iNodeName){
+        nodeName = iNodeName;
+    }
+    virtual ~Node(){}
+    Node& AddChild(Node& iChild);
+    // Unlink iChild (and with it its subtree) from this node.
+    void RemoveChild(Node& iChild);
+
+    // Children are kept in an intrusive list, so linking a node allocates nothing.
+    Node* GetFirstChild();
+    Node* GetNextSibling();
+
+    // The local transformation is kept in its compact tagged form. The world
+    // transformation (a compact 2x3 affine) is cached and only recomputed when a setter has marked this node
+    // (or one of its ancestors) dirty since the last query.
+    const Transform2D& GetLocalTransformation();
+    const Affine2x3& GetWorldTransformation();
+
+    // World-space bounds of this node's geometry, and of that and every
+    // descendant's together. Cached like the world transformation: edits mark
+    // the bounds of the node, its subtree and its ancestors dirty, and only
+    // dirty nodes are recomputed on the next query.
+    const Aabb2& GetGeometryWorldBounds();
+    const Aabb2& GetSubtreeBounds();
+
+    // Called by TransformHierarchy::Compile(), the node then writes its edits into the hierarchy.
+    void BindToHierarchy(TransformHierarchy* iHierarchyPtr, int iIndex);
+    void AddGeo(GeometryId iGeoId);
+
+    void ModifyColor(glm::vec3 iColor);
+
+    GeometryId GetGeoId();
+    glm::vec3 GetColor();
+    const char* GetName();
+    Node* GetParent();
+    unsigned GetNodeType();
+    NodeHandle GetHandle();
+protected:
+    // Called by the setters of the derived nodes whenever a parameter changes.
+    void SetLocalTransformation(const Transform2D& iLocal);
+    // Invalidates the world matrix, and with it the bounds, of this node and its whole subtree.
+    void MarkWorldDirty();
+    // Invalidates the subtree bounds of this node and its ancestors.
+    void MarkBoundsDirty();
+
+    Node* parentPtr = nullptr;
+    Node* firstChildPtr = nullptr;
+    Node* lastChildPtr = nullptr;
+    Node* nextSiblingPtr = nullptr;
+    NodeHandle handle = INVALID_NODE_HANDLE;
+
+    Transform2D localTransform = Transform2D::Identity();
+    Affine2x3 worldMat;
+    bool worldDirty = true;
+    Aabb2 geoBounds;
+    Aabb2 subtreeBounds;
+    bool boundsDirty = true; // A node with dirty bounds always has dirty ancestors.
+
+    TransformHierarchy* hierarchyPtr = nullptr;
+    int hierarchyIndex = -1;
+
+    GeometryId geoId = GEO_NONE;
+    glm::vec3 color;
+    const char* nodeName;
+    unsigned int nodeType;// 0 - Node, 1 - TranslateNode, 2 - RotateNode, 3 - ScaleNode;
+    unsigned int col = 0;
+};
+
+class TranslateNode : public Node
+{
+public:
+    TranslateNode(float ix, float iy, const char* iNodeName);
+    ~TranslateNode(){}
+
+    float GetXTranslation();
+    float GetYTranslation();
+
+    void SetXTranslation(float i);
+    void SetYTranslation(float i);
+private:
+    float xTranslation;
+    float yTranslation;
+};
+
+class RotateNode : public Node
+{
+public:
+    RotateNode(float imagnitude, const char* iNodeName);
+    ~RotateNode(){}
+
+    float GetMagnitude();
+
+    void SetMagnitude(float i);
+
+private:
+    float magnitude;// Magnitude is at the unit of radian.
+};
+
+class ScaleNode : public Node
+{
+public:
+    ScaleNode(float ixScalar, float iyScalar, const char* iNodeName);
+    ~ScaleNode(){}
+
+    float GetXScalar();
+    float GetYScalar();
+
+    void SetXScalar(float i);
+    void SetYScalar(float i);
+private:
+    float xScalar;
+    float yScalar;
+};
+
+
+#endif // NODE_H
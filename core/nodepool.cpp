@@ -0,0 +1,160 @@
+#include "nodepool.h"
+#include "transformhierarchy.h"
+#include <cstring>
+
+static const unsigned int STRING_BLOCK_SIZE = 64 * 1024;
+static const unsigned int HANDLE_TYPE_SHIFT = NODE_HANDLE_SLOT_BITS + NODE_HANDLE_GENERATION_BITS;
+static const unsigned int HANDLE_GENERATION_SHIFT = NODE_HANDLE_SLOT_BITS;
+static const unsigned int HANDLE_GENERATION_MASK = (1u << NODE_HANDLE_GENERATION_BITS) - 1;
+static const unsigned int HANDLE_SLOT_MASK = (1u << HANDLE_GENERATION_SHIFT) - 1;
+
+NodePool::NodePool()
+    : stringBlockUsed(0), stringBlockSize(0)
+{}
+
+NodePool::~NodePool()
+{
+    Clear();
+}
+
+TranslateNode& NodePool::CreateTranslate(float ix, float iy, const char* iNodeName, bool iCopyName)
+{
+    unsigned int slot;
+    TranslateNode& node = translateSlab.Create(stats, slot, ix, iy, iCopyName ? InternName(iNodeName) : iNodeName);
+    node.handle = MakeHandle(1, slot, translateSlab.GetGeneration(slot));
+    return node;
+}
+
+RotateNode& NodePool::CreateRotate(float imagnitude, const char* iNodeName, bool iCopyName)
+{
+    unsigned int slot;
+    RotateNode& node = rotateSlab.Create(stats, slot, imagnitude, iCopyName ? InternName(iNodeName) : iNodeName);
+    node.handle = MakeHandle(2, slot, rotateSlab.GetGeneration(slot));
+    return node;
+}
+
+ScaleNode& NodePool::CreateScale(float ixScalar, float iyScalar, const char* iNodeName, bool iCopyName)
+{
+    unsigned int slot;
+    ScaleNode& node = scaleSlab.Create(stats, slot, ixScalar, iyScalar, iCopyName ? InternName(iNodeName) : iNodeName);
+    node.handle = MakeHandle(3, slot, scaleSlab.GetGeneration(slot));
+    return node;
+}
+
+Node* NodePool::Get(NodeHandle iHandle)
+{
+    unsigned int slot = iHandle & HANDLE_SLOT_MASK;
+    unsigned int generation = (iHandle >> HANDLE_GENERATION_SHIFT) & HANDLE_GENERATION_MASK;
+    switch (iHandle >> HANDLE_TYPE_SHIFT)
+    {
+        case 1: // TranslateNode;
+            return translateSlab.Get(slot, generation, HANDLE_GENERATION_MASK);
+        case 2: // RotateNode;
+            return rotateSlab.Get(slot, generation, HANDLE_GENERATION_MASK);
+        case 3: // ScaleNode;
+            return scaleSlab.Get(slot, generation, HANDLE_GENERATION_MASK);
+    }
+    return nullptr;
+}
+
+NodeHandle NodePool::MakeHandle(unsigned int iType, unsigned int iSlot, unsigned int iGeneration)
+{
+    return (iType << HANDLE_TYPE_SHIFT) |
+           ((iGeneration & HANDLE_GENERATION_MASK) << HANDLE_GENERATION_SHIFT) |
+           iSlot;
+}
+
+void NodePool::DestroySubtree(Node& iNode)
+{
+    if (iNode.GetParent() != nullptr)
+    {
+        iNode.GetParent()->RemoveChild(iNode);
+    }
+    else if (iNode.hierarchyPtr != nullptr)
+    {
+        // A whole compiled tree goes away; the hierarchy must not keep pointers into it.
+        iNode.hierarchyPtr->Invalidate();
+    }
+
+    // Collect first: destroying a node ends the lifetime of its sibling links.
+    std::vector<Node*> subtree;
+    subtree.push_back(&iNode);
+    for (size_t i = 0; i < subtree.size(); i++)
+    {
+        for (Node* p = subtree[i]->GetFirstChild(); p != nullptr; p = p->GetNextSibling())
+        {
+            subtree.push_back(p);
+        }
+    }
+    for (std::vector<Node*>::iterator p = subtree.begin(); p != subtree.end(); p++)
+    {
+        Destroy(**p);
+    }
+}
+
+void NodePool::Destroy(Node& iNode)
+{
+    unsigned int slot = iNode.GetHandle() & HANDLE_SLOT_MASK;
+    switch (iNode.GetHandle() >> HANDLE_TYPE_SHIFT)
+    {
+        case 1: // TranslateNode;
+            translateSlab.Destroy(slot);
+            break;
+        case 2: // RotateNode;
+            rotateSlab.Destroy(slot);
+            break;
+        case 3: // ScaleNode;
+            scaleSlab.Destroy(slot);
+            break;
+    }
+}
+
+unsigned int NodePool::Size() const
+{
+    return translateSlab.Size() + rotateSlab.Size() + scaleSlab.Size();
+}
+
+void NodePool::Clear()
+{
+    // Invalidating a hierarchy unbinds all of its nodes, so this costs one
+    // Invalidate() per hierarchy and a check per node.
+    auto unbind = [](Node& iNode)
+    {
+        if (iNode.hierarchyPtr != nullptr)
+        {
+            iNode.hierarchyPtr->Invalidate();
+        }
+    };
+    translateSlab.ForEach(unbind);
+    rotateSlab.ForEach(unbind);
+    scaleSlab.ForEach(unbind);
+    translateSlab.Clear();
+    rotateSlab.Clear();
+    scaleSlab.Clear();
+    stringBlocks.clear();
+    stringBlockUsed = 0;
+    stringBlockSize = 0;
+}
+
+const NodePoolStats& NodePool::GetStats() const
+{
+    return stats;
+}
+
+const char* NodePool::InternName(const char* iName)
+{
+    unsigned int length = static_cast<unsigned int>(std::strlen(iName)) + 1;
+    if (stringBlocks.empty() || stringBlockUsed + length > stringBlockSize)
+    {
+        // Names longer than a block get a block of their own.
+        stringBlockSize = length > STRING_BLOCK_SIZE ? length : STRING_BLOCK_SIZE;
+        stringBlocks.push_back(uPtr<char[]>(new char[stringBlockSize]));
+        stringBlockUsed = 0;
+        stats.stringBlockAllocations++;
+        stats.bytesReserved += stringBlockSize;
+    }
+    char* name = stringBlocks.back().get() + stringBlockUsed;
+    std::memcpy(name, iName, length);
+    stringBlockUsed += length;
+    return name;
+}
@@ -0,0 +1,205 @@
+#pragma once
+#include "node.h"
+#include "smartpointerhelp.h"
+#include <new>
+#include <utility>
+#include <vector>
+
+// Counters that show how often the pool had to go to the general-purpose allocator.
+// Building a scene should increase nodesCreated by one per node but chunkAllocations
+// and stringBlockAllocations only once per few thousand nodes.
+struct NodePoolStats
+{
+    unsigned long long nodesCreated = 0;
+    unsigned long long chunkAllocations = 0;
+    unsigned long long stringBlockAllocations = 0;
+    unsigned long long bytesReserved = 0;
+};
+
+// NodeHandle layout: type (2 bits) | generation (6 bits) | slot (24 bits).
+const unsigned int NODE_HANDLE_SLOT_BITS = 24;
+const unsigned int NODE_HANDLE_GENERATION_BITS = 6;
+
+// Storage for nodes of one concrete type. Nodes are constructed in place in
+// fixed-size chunks which never move, so pointers stay valid until the node
+// is destroyed. Destroyed slots are reused; each slot carries a generation
+// that is bumped on destruction so stale handles can be detected.
+// A handle only has room for MAX_GENERATION + 1 generations, so a slot is
+// retired instead of reused once it reaches MAX_GENERATION: a stale handle
+// never resolves to a later node in the same slot.
+template<typename T>
+class NodeSlab
+{
+public:
+    static const unsigned int CHUNK_SIZE = 4096;
+    static const unsigned int MAX_SLOTS = 1u << NODE_HANDLE_SLOT_BITS;
+    static const unsigned int MAX_GENERATION = (1u << NODE_HANDLE_GENERATION_BITS) - 1;
+
+    NodeSlab() : count(0), retired(0) {}
+    ~NodeSlab() { Clear(); }
+    NodeSlab(const NodeSlab&) = delete;
+    NodeSlab& operator=(const NodeSlab&) = delete;
+
+    template<typename... Args>
+    T& Create(NodePoolStats& ioStats, unsigned int& oSlot, Args&&... args)
+    {
+        if (!freeSlots.empty())
+        {
+            oSlot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else
+        {
+            if (count == MAX_SLOTS)
+            {
+                // Every slot a handle can address is in use or retired.
+                throw std::bad_alloc();
+            }
+            oSlot = count++;
+            if (oSlot / CHUNK_SIZE == chunks.size())
+            {
+                chunks.push_back(mkU<Chunk>());
+                ioStats.chunkAllocations++;
+                ioStats.bytesReserved += sizeof(Chunk);
+            }
+            generation.push_back(0);
+            alive.push_back(0);
+        }
+        T* ptr = new (Address(oSlot)) T(std::forward<Args>(args)...);
+        alive[oSlot] = 1;
+        ioStats.nodesCreated++;
+        return *ptr;
+    }
+
+    void Destroy(unsigned int iSlot)
+    {
+        Address(iSlot)->~T();
+        alive[iSlot] = 0;
+        if (++generation[iSlot] < MAX_GENERATION)
+        {
+            freeSlots.push_back(iSlot);
+        }
+        else
+        {
+            retired++;
+        }
+    }
+
+    // The live node in iSlot, or nullptr if the slot is free or was reused since iGeneration.
+    T* Get(unsigned int iSlot, unsigned int iGeneration, unsigned int iGenerationMask)
+    {
+        if (iSlot >= count || !alive[iSlot] || (generation[iSlot] & iGenerationMask) != iGeneration)
+        {
+            return nullptr;
+        }
+        return Address(iSlot);
+    }
+
+    unsigned int GetGeneration(unsigned int iSlot) const
+    {
+        return generation[iSlot];
+    }
+
+    unsigned int Size() const
+    {
+        return count - static_cast<unsigned int>(freeSlots.size()) - retired;
+    }
+
+    // Call iVisit with every live node.
+    template<typename F>
+    void ForEach(F iVisit)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (alive[i])
+            {
+                iVisit(*Address(i));
+            }
+        }
+    }
+
+    // Destroy every node and give the chunks back in one go. The generations
+    // start over, so handles from before can no longer be told apart from new ones.
+    void Clear()
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (alive[i])
+            {
+                Address(i)->~T();
+            }
+        }
+        chunks.clear();
+        generation.clear();
+        alive.clear();
+        freeSlots.clear();
+        count = 0;
+        retired = 0;
+    }
+
+private:
+    struct Chunk
+    {
+        alignas(T) unsigned char data[CHUNK_SIZE * sizeof(T)];
+    };
+
+    T* Address(unsigned int iSlot)
+    {
+        return reinterpret_cast<T*>(chunks[iSlot / CHUNK_SIZE]->data + (iSlot % CHUNK_SIZE) * sizeof(T));
+    }
+
+    std::vector<uPtr<Chunk>> chunks;
+    std::vector<unsigned int> generation;
+    std::vector<unsigned char> alive;
+    std::vector<unsigned int> freeSlots;
+    unsigned int count;
+    unsigned int retired; // Slots that reached MAX_GENERATION
+};
+
+// Owns every node of a scene: one slab per node type plus a pool for the node names.
+// Nodes are addressed by a NodeHandle. Get() resolves a handle in constant time
+// and returns nullptr once the node has been destroyed, until Clear().
+// Each node type has room for 1 << 24 slots; creating a node beyond that throws
+// std::bad_alloc.
+class NodePool
+{
+public:
+    NodePool();
+    ~NodePool();
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    // iNodeName is copied into the pool. With iCopyName false it is used as it
+    // is and has to outlive the node, e.g. a name in a mapped scene file.
+    TranslateNode& CreateTranslate(float ix, float iy, const char* iNodeName, bool iCopyName = true);
+    RotateNode& CreateRotate(float imagnitude, const char* iNodeName, bool iCopyName = true);
+    ScaleNode& CreateScale(float ixScalar, float iyScalar, const char* iNodeName, bool iCopyName = true);
+
+    Node* Get(NodeHandle iHandle);
+    unsigned int Size() const;
+
+    // Unlink iNode from its parent and destroy it together with all of its descendants.
+    // Their names stay in the string blocks until Clear().
+    void DestroySubtree(Node& iNode);
+    // Destroy all nodes at once, e.g. when the scene is torn down or replaced.
+    // Hierarchies compiled from them are invalidated first.
+    void Clear();
+
+    const NodePoolStats& GetStats() const;
+
+private:
+    // Copy iName into the string blocks, so the nodes need no allocation of their own.
+    const char* InternName(const char* iName);
+    NodeHandle MakeHandle(unsigned int iType, unsigned int iSlot, unsigned int iGeneration);
+    void Destroy(Node& iNode);
+
+    NodeSlab<TranslateNode> translateSlab;
+    NodeSlab<RotateNode> rotateSlab;
+    NodeSlab<ScaleNode> scaleSlab;
+
+    std::vector<uPtr<char[]>> stringBlocks;
+    unsigned int stringBlockUsed;
+    unsigned int stringBlockSize;
+
+    NodePoolStats stats;
+};
@@ -0,0 +1,71 @@
+#include "renderqueue.h"
+
+void RenderQueue::Clear()
+{
+    packets.clear();
+}
+
+unsigned int RenderQueue::CountStateChanges(const std::vector<DrawPacket>& iPackets)
+{
+    // The first packet has to bind its state too.
+    unsigned int changes = 0;
+    std::uint64_t bound = ~std::uint64_t(0);
+    for (std::vector<DrawPacket>::const_iterator p = iPackets.begin(); p != iPackets.end(); p++)
+    {
+        std::uint64_t state = GetState(p->key);
+        changes += state != bound;
+        bound = state;
+    }
+    return changes;
+}
+
+void RenderQueue::Sort()
+{
+    stats.packets = static_cast<unsigned int>(packets.size());
+    stats.stateChangesPushed = CountStateChanges(packets);
+
+    // One pass over the keys builds the histograms of all eight bytes.
+    static const int BYTES = 8;
+    unsigned int counts[BYTES * 256] = {0};
+    for (std::vector<DrawPacket>::const_iterator p = packets.begin(); p != packets.end(); p++)
+    {
+        for (int b = 0; b < BYTES; b++)
+        {
+            counts[b * 256 + ((p->key >> (8 * b)) & 0xff)]++;
+        }
+    }
+
+    scratch.resize(packets.size());
+    for (int b = 0; b < BYTES && !packets.empty(); b++)
+    {
+        unsigned int* count = &counts[b * 256];
+        if (count[(packets[0].key >> (8 * b)) & 0xff] == packets.size())
+        {
+            continue;
+        }
+        unsigned int offset = 0;
+        for (int v = 0; v < 256; v++)
+        {
+            unsigned int c = count[v];
+            count[v] = offset;
+            offset += c;
+        }
+        for (std::vector<DrawPacket>::const_iterator p = packets.begin(); p != packets.end(); p++)
+        {
+            scratch[count[(p->key >> (8 * b)) & 0xff]++] = *p;
+        }
+        packets.swap(scratch);
+    }
+
+    stats.stateChangesSorted = CountStateChanges(packets);
+}
+
+const std::vector<DrawPacket>& RenderQueue::GetPackets() const
+{
+    return packets;
+}
+
+const RenderQueueStats& RenderQueue::GetStats() const
+{
+    return stats;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// One draw: its sort key and the caller's index of what to draw.
+struct DrawPacket
+{
+    std::uint64_t key;
+    std::uint32_t item;
+};
+
+// How often the render state (layer, program or geometry) changes between
+// consecutive packets, in the order they were pushed and after sorting.
+struct RenderQueueStats
+{
+    unsigned int packets = 0;
+    unsigned int stateChangesPushed = 0;
+    unsigned int stateChangesSorted = 0;
+};
+
+// Collects the draws of a frame and orders them by a 64-bit key, most
+// significant field first:
+//
+//   bits 56-63  layer      every packet of a lower layer comes before any of a higher one
+//   bits 48-55  program
+//   bits 32-47  geometry
+//   bits  0-31  depth      the order within one state
+//
+// Sorting groups equal state, so submission only has to bind when the upper
+// 32 bits change. Draws whose relative order has to survive the sort either
+// go into separate layers, or keep their order through the depth field and
+// a depth test.
+class RenderQueue
+{
+public:
+    static std::uint64_t MakeKey(unsigned int iLayer, unsigned int iProgram, unsigned int iGeometry, std::uint32_t iDepth)
+    {
+        return (std::uint64_t(iLayer & 0xff) << 56) | (std::uint64_t(iProgram & 0xff) << 48) |
+               (std::uint64_t(iGeometry & 0xffff) << 32) | iDepth;
+    }
+    static std::uint64_t GetState(std::uint64_t iKey) { return iKey >> 32; }
+    static unsigned int GetProgram(std::uint64_t iKey) { return unsigned((iKey >> 48) & 0xff); }
+    static unsigned int GetGeometry(std::uint64_t iKey) { return unsigned((iKey >> 32) & 0xffff); }
+    static std::uint32_t GetDepth(std::uint64_t iKey) { return std::uint32_t(iKey); }
+
+    void Clear();
+    void Push(std::uint64_t iKey, std::uint32_t iItem)
+    {
+        DrawPacket packet = {iKey, iItem};
+        packets.push_back(packet);
+    }
+    // Stable LSD radix sort, a byte per pass. Bytes that are equal in every
+    // key, e.g. the layer in a one-layer frame, cost no pass.
+    void Sort();
+
+    const std::vector<DrawPacket>& GetPackets() const;
+    // Filled in by Sort().
+    const RenderQueueStats& GetStats() const;
+
+private:
+    static unsigned int CountStateChanges(const std::vector<DrawPacket>& iPackets);
+
+    std::vector<DrawPacket> packets;
+    std::vector<DrawPacket> scratch;
+    RenderQueueStats stats;
+};
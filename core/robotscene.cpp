@@ -0,0 +1,139 @@
+#include "robotscene.h"
+
+Node& BuildRobotScene(NodePool& ioPool)
+{
+    // Every node is placed in ioPool's slabs, which also own the names.
+    Node& root = ioPool.CreateTranslate(0.f, 0.f, "Root");
+
+    // For Upper Body.
+    Node& upperBodyTRef = root.AddChild(ioPool.CreateTranslate(0.f, 2.f, "upper body T"));
+    Node& upperBodyRRef = upperBodyTRef.AddChild(ioPool.CreateRotate(0.f, "upper body R"));
+    Node& upperBodySRef = upperBodyRRef.AddChild(ioPool.CreateScale(1.f, 1.f, "upper body S"));
+
+
+    // For Right Leg.
+    Node& rightLegTRef = upperBodySRef.AddChild(ioPool.CreateTranslate(0.5f, -2.f, "right leg T"));
+    Node& rightLegRRef = rightLegTRef.AddChild(ioPool.CreateRotate(0.f, "right leg R"));
+    Node& rightLegSRef = rightLegRRef.AddChild(ioPool.CreateScale(1.f, 1.f, "right leg S"));
+
+    Node& rightShoeTRef = rightLegSRef.AddChild(ioPool.CreateTranslate(0.55f, -3.75f, "right shoe T"));
+    Node& rightForeLegTRef = rightLegSRef.AddChild(ioPool.CreateTranslate(0.3f, 0.25f, "right fore leg T"));
+    Node& rightBackLegTRef = rightLegSRef.AddChild(ioPool.CreateTranslate(0.3f, -1.5f, "right back leg T"));
+
+
+    // For Right Back Leg.
+    Node& rightBackLegRRef = rightBackLegTRef.AddChild(ioPool.CreateRotate(0.f, "right back leg R"));
+    Node& rightBackLegTInnerRef = rightBackLegRRef.AddChild(ioPool.CreateTranslate(-0.3f, -1.f, "right fore leg inner T"));
+    Node& rightBackLegSRef = rightBackLegTInnerRef.AddChild(ioPool.CreateScale(0.8f, 2.5f, "right back leg S"));
+    rightBackLegSRef.AddGeo(GEO_RECTANGLE);
+    rightBackLegSRef.ModifyColor(glm::vec3(1.f, 0.5f, 0.f));
+
+    // For Right Fore Leg.
+    Node& rightForeLegRRef = rightForeLegTRef.AddChild(ioPool.CreateRotate(0.f, "right fore leg R"));
+    Node& rightForeLegTInnerRef = rightForeLegRRef.AddChild(ioPool.CreateTranslate(-0.3f, -1.f, "right fore leg inner T"));
+    Node& rightForeLegSRef = rightForeLegTInnerRef.AddChild(ioPool.CreateScale(0.8f, 2.5f, "right fore leg S"));
+    rightForeLegSRef.AddGeo(GEO_RECTANGLE);
+    rightForeLegSRef.ModifyColor(glm::vec3(0.5f, 0.2f, 0.8f));
+
+    // For Right Shoe.
+    Node& rightShoeRRef = rightShoeTRef.AddChild(ioPool.CreateRotate(0.f, "right shoe R"));
+    Node& rightShoeTInnerRef = rightShoeRRef.AddChild(ioPool.CreateTranslate(-0.3f, -0.3f, "left shoe inner T"));
+    Node& rightShoeSRef = rightShoeTInnerRef.AddChild(ioPool.CreateScale(0.6f, 0.6f, "right shoe S"));
+    rightShoeSRef.AddGeo(GEO_SHOE);
+    rightShoeSRef.ModifyColor(glm::vec3(0.0f, 0.0f, 0.0f));
+
+
+    // For left leg.
+    Node& leftLegTRef = upperBodySRef.AddChild(ioPool.CreateTranslate(-0.5f, -2.f, "left leg T"));
+    Node& leftLegRRef = leftLegTRef.AddChild(ioPool.CreateRotate(0.f, "left leg R"));
+    Node& leftLegSRef = leftLegRRef.AddChild(ioPool.CreateScale(1.f, 1.f, "left back leg S"));
+
+    // For Left Fore Leg.
+    Node& leftForeLegTRef = leftLegSRef.AddChild(ioPool.CreateTranslate(0.f, 0.25f, "left fore leg T"));
+    Node& leftForeLegRRef = leftForeLegTRef.AddChild(ioPool.CreateRotate(0.f, "left fore leg R"));
+    Node& leftForeLegTInnerRef = leftForeLegRRef.AddChild(ioPool.CreateTranslate(0.f, -1.f, "left fore leg inner T"));
+    Node& leftForeLegSRef = leftForeLegTInnerRef.AddChild(ioPool.CreateScale(0.8f, 2.5f, "left fore leg S"));
+    leftForeLegSRef.AddGeo(GEO_RECTANGLE);
+    leftForeLegSRef.ModifyColor(glm::vec3(0.5f, 0.2f, 0.8f));
+
+    // For left Shoe.
+    Node& leftShoeTRef = leftLegSRef.AddChild(ioPool.CreateTranslate(-0.05f, -3.75f, "left shoe T"));
+    Node& leftShoeRRef = leftShoeTRef.AddChild(ioPool.CreateRotate(0.f, "left shoe R"));
+    Node& leftShoeTInnerRef = leftShoeRRef.AddChild(ioPool.CreateTranslate(-0.3f, -0.3f, "left shoe inner T"));
+    Node& leftShoeSRef = leftShoeTInnerRef.AddChild(ioPool.CreateScale(-0.6f, 0.6f, "right shoe S"));
+    leftShoeSRef.AddGeo(GEO_SHOE);
+    leftShoeSRef.ModifyColor(glm::vec3(0.0f, 0.0f, 0.0f));
+
+    // For Left Back leg.
+    Node& leftBackLegTRef = leftLegSRef.AddChild(ioPool.CreateTranslate(0.f, -1.5f, "left back leg T"));
+    Node& leftBackLegRRef = leftBackLegTRef.AddChild(ioPool.CreateRotate(0.f, "left back leg R"));
+    Node& leftBackLegTInnerRef = leftBackLegRRef.AddChild(ioPool.CreateTranslate(0.f, -1.f, "left back leg inner T"));
+    Node& leftBackLegSRef = leftBackLegTInnerRef.AddChild(ioPool.CreateScale(0.8f, 2.5f, "left back leg S"));
+    leftBackLegSRef.AddGeo(GEO_RECTANGLE);
+    leftBackLegSRef.ModifyColor(glm::vec3(1.f, 0.5f, 0.f));
+
+
+    // For Right Arm.
+    Node& rightArmTRef = upperBodySRef.AddChild(ioPool.CreateTranslate(0.5f, 0.5f, "right arm T"));
+    Node& rightArmRRef = rightArmTRef.AddChild(ioPool.CreateRotate(0.f, "right arm R"));
+    Node& rightArmSRef = rightArmRRef.AddChild(ioPool.CreateScale(1.f, 1.f, "right arm S"));
+
+    // For Right Fore Arm (RFA).
+    Node& RFATRef = rightArmSRef.AddChild(ioPool.CreateTranslate(1.5f, 0.f, "right fore arm T"));
+    Node& RFARRef = RFATRef.AddChild(ioPool.CreateRotate(0.f, "right fore arm R"));
+    Node& rightForeArmTInnerRef = RFARRef.AddChild(ioPool.CreateTranslate(0.f, -0.5f, "right fore arm inner T"));
+    Node& RFASRef = rightForeArmTInnerRef.AddChild(ioPool.CreateScale(0.5f, 2.0f, "right fore arm S"));
+    RFASRef.AddGeo(GEO_RECTANGLE);
+    RFASRef.ModifyColor(glm::vec3(1.f, 0.5f, 0.f));
+
+    // For Right Back Arm(RBA).
+    Node& RBATRef = rightArmSRef.AddChild(ioPool.CreateTranslate(0.25f, 0.25f, "Back right Arm T"));
+    Node& RBARRef = RBATRef.AddChild(ioPool.CreateRotate(0.f, "Back right Arm R"));
+    Node& rightBackArmTInnerRef = RBARRef.AddChild(ioPool.CreateTranslate(0.5f, 0.f, "right fore arm inner T"));
+    Node& RBASRef = rightBackArmTInnerRef.AddChild(ioPool.CreateScale(2.f, 0.5f, "Back right Arm S"));
+    RBASRef.AddGeo(GEO_RECTANGLE);
+    RBASRef.ModifyColor(glm::vec3(0.f, 1.f, 0.f));
+
+
+    // For Left Arm
+    Node& leftArmTRef = upperBodySRef.AddChild(ioPool.CreateTranslate(-1.f, 0.5f, "left arm T"));
+    Node& leftArmRRef = leftArmTRef.AddChild(ioPool.CreateRotate(0.f, "left arm R"));
+    Node& leftArmSRef = leftArmRRef.AddChild(ioPool.CreateScale(1.f, 1.f, "left arm S"));
+
+    // For Left Fore Arm (LFA).
+    Node& FLATRef = leftArmSRef.AddChild(ioPool.CreateTranslate(-1.f, 0.f, "Fore Left Arm T"));
+    Node& FLARRef = FLATRef.AddChild(ioPool.CreateRotate(0.f, "Fore Left Arm R"));
+    Node& leftForeArmTInnerRef = FLARRef.AddChild(ioPool.CreateTranslate(0.0f, -0.5f, "left fore arm inner T"));
+    Node& FLASRef = leftForeArmTInnerRef.AddChild(ioPool.CreateScale(0.5f, 2.0f, "Fore Left Arm S"));
+    FLASRef.AddGeo(GEO_RECTANGLE);
+    FLASRef.ModifyColor(glm::vec3(1.f, 0.5f, 0.f));
+
+    // For Left Back Arm (LBA).
+    Node& BLATRef = leftArmSRef.AddChild(ioPool.CreateTranslate(-0.25f, 0.25f, "Back Left Arm T"));
+    Node& BLARRef = BLATRef.AddChild(ioPool.CreateRotate(0.f, "Back Left Arm R"));
+    Node& BLASRef = BLARRef.AddChild(ioPool.CreateScale(2.f, 0.5f, "Back Left Arm S"));
+    BLASRef.AddGeo(GEO_RECTANGLE);
+    BLASRef.ModifyColor(glm::vec3(0.f, 1.f, 0.f));
+
+
+    // For Head.
+    Node& headTRef = upperBodySRef.AddChild(ioPool.CreateTranslate(0.f, 1.5f, "head T"));
+    Node& headSRef = headTRef.AddChild(ioPool.CreateScale(1.f, 1.f, "head S"));
+    headSRef.AddGeo(GEO_CIRCLE);
+    headSRef.ModifyColor(glm::vec3(0.f, 1.f, 0.f));
+
+    // For downward body.
+    Node& downwardBodyTRef = upperBodySRef.AddChild(ioPool.CreateTranslate(0.f, -1.5f, "downward Body T"));
+    Node& downwardBodyRRef = downwardBodyTRef.AddChild(ioPool.CreateRotate(0.f, "downward Body R"));
+    Node& downwardBodySRef = downwardBodyRRef.AddChild(ioPool.CreateScale(1.f, 1.f, "downward Body S"));
+    downwardBodySRef.AddGeo(GEO_TRAPEZOID);
+    downwardBodySRef.ModifyColor(glm::vec3(1.f, 1.f, 0.f));
+
+    // For upper Body.
+    Node& upperBodyRRRef = upperBodySRef.AddChild(ioPool.CreateRotate(180.f, "upper Body R"));
+    Node& upperBodySSRef = upperBodyRRRef.AddChild(ioPool.CreateScale(1.f, 2.f, "upper Body S"));
+    upperBodySSRef.AddGeo(GEO_TRAPEZOID);
+    upperBodySSRef.ModifyColor(glm::vec3(1.f, 1.f, 0.f));
+
+    return root;
+}
@@ -0,0 +1,6 @@
+#pragma once
+#include "node.h"
+#include "nodepool.h"
+
+// The default scene: a robot of 62 nodes with 13 shapes. Returns its root.
+Node& BuildRobotScene(NodePool& ioPool);
@@ -0,0 +1,221 @@
+#include "scenefile.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static std::uint64_t AlignTo8(std::uint64_t iOffset)
+{
+    return (iOffset + 7) & ~std::uint64_t(7);
+}
+
+bool SaveSceneFile(const char* iPath, Node& iRoot, std::string* oError)
+{
+    // Pre-order walk over the intrusive links; parents get their index before their children.
+    std::vector<SceneFileNode> records;
+    std::vector<char> names;
+    std::vector<int> path;
+    Node* current = &iRoot;
+    while (current != nullptr)
+    {
+        SceneFileNode record;
+        std::memset(&record, 0, sizeof(record));
+        record.type = current->GetNodeType();
+        record.parent = path.empty() ? -1 : path.back();
+        switch (record.type)
+        {
+            case 1: // TranslateNode;
+                record.params[0] = static_cast<TranslateNode*>(current)->GetXTranslation();
+                record.params[1] = static_cast<TranslateNode*>(current)->GetYTranslation();
+                break;
+            case 2: // RotateNode;
+                record.params[0] = static_cast<RotateNode*>(current)->GetMagnitude();
+                break;
+            case 3: // ScaleNode;
+                record.params[0] = static_cast<ScaleNode*>(current)->GetXScalar();
+                record.params[1] = static_cast<ScaleNode*>(current)->GetYScalar();
+                break;
+        }
+        record.nameOffset = static_cast<std::uint32_t>(names.size());
+        record.geoId = current->GetGeoId();
+        glm::vec3 color = current->GetColor();
+        record.color[0] = color.r;
+        record.color[1] = color.g;
+        record.color[2] = color.b;
+        const char* name = current->GetName();
+        names.insert(names.end(), name, name + std::strlen(name) + 1);
+        records.push_back(record);
+
+        if (current->GetFirstChild() != nullptr)
+        {
+            path.push_back(static_cast<int>(records.size()) - 1);
+            current = current->GetFirstChild();
+            continue;
+        }
+        while (current != &iRoot && current->GetNextSibling() == nullptr)
+        {
+            current = current->GetParent();
+            path.pop_back();
+        }
+        current = current != &iRoot ? current->GetNextSibling() : nullptr;
+    }
+
+    SceneFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SCENE_FILE_MAGIC, sizeof(header.magic));
+    header.version = SCENE_FILE_VERSION;
+    header.nodeCount = static_cast<std::uint32_t>(records.size());
+    header.nodeTableOffset = AlignTo8(sizeof(header));
+    header.stringPoolOffset = AlignTo8(header.nodeTableOffset + records.size() * sizeof(SceneFileNode));
+    header.stringPoolSize = names.size();
+
+    FILE* out = std::fopen(iPath, "wb");
+    if (out == nullptr)
+    {
+        if (oError != nullptr)
+        {
+            *oError = std::string("cannot open ") + iPath + " for writing";
+        }
+        return false;
+    }
+    const char padding[8] = {0};
+    std::uint64_t tablePadding = header.stringPoolOffset - header.nodeTableOffset - records.size() * sizeof(SceneFileNode);
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+              std::fwrite(padding, 1, header.nodeTableOffset - sizeof(header), out) == header.nodeTableOffset - sizeof(header) &&
+              std::fwrite(records.data(), sizeof(SceneFileNode), records.size(), out) == records.size() &&
+              std::fwrite(padding, 1, tablePadding, out) == tablePadding &&
+              std::fwrite(names.data(), 1, names.size(), out) == names.size();
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok && oError != nullptr)
+    {
+        *oError = std::string("cannot write ") + iPath;
+    }
+    return ok;
+}
+
+SceneFile::SceneFile()
+    : nodes(nullptr), stringPool(nullptr), nodeCount(0)
+{}
+
+bool SceneFile::Fail(const char* iReason)
+{
+    error = iReason;
+    file.Close();
+    nodes = nullptr;
+    stringPool = nullptr;
+    nodeCount = 0;
+    return false;
+}
+
+bool SceneFile::Open(const char* iPath)
+{
+    error.clear();
+    if (!file.Open(iPath))
+    {
+        return Fail("cannot map the file");
+    }
+
+    const unsigned char* data = file.GetData();
+    std::uint64_t size = file.GetSize();
+    if (size < sizeof(SceneFileHeader))
+    {
+        return Fail("file is too small for a scene header");
+    }
+    const SceneFileHeader& header = *reinterpret_cast<const SceneFileHeader*>(data);
+    if (std::memcmp(header.magic, SCENE_FILE_MAGIC, sizeof(header.magic)) != 0)
+    {
+        return Fail("not a scene file");
+    }
+    // Versions are small, so in a little-endian file the first byte of the
+    // version is its only nonzero one. Read as bytes, this holds on any host.
+    const unsigned char* version = data + offsetof(SceneFileHeader, version);
+    if (version[0] == 0 && version[3] != 0)
+    {
+        return Fail("scene file has the wrong byte order");
+    }
+    if (header.version != SCENE_FILE_VERSION)
+    {
+        return Fail("unsupported scene file version");
+    }
+    if (header.nodeCount == 0 ||
+        header.nodeTableOffset % 8 != 0 || header.nodeTableOffset > size ||
+        header.nodeCount > (size - header.nodeTableOffset) / sizeof(SceneFileNode) ||
+        header.stringPoolOffset > size || header.stringPoolSize > size - header.stringPoolOffset ||
+        header.stringPoolSize == 0 || data[header.stringPoolOffset + header.stringPoolSize - 1] != '\0')
+    {
+        return Fail("scene file sections are out of bounds");
+    }
+
+    // The only pass over the records: check that every one is usable as it is.
+    const SceneFileNode* records = reinterpret_cast<const SceneFileNode*>(data + header.nodeTableOffset);
+    for (std::uint32_t i = 0; i < header.nodeCount; i++)
+    {
+        const SceneFileNode& record = records[i];
+        bool parentOk = i == 0 ? record.parent == -1 : (record.parent >= 0 && std::uint32_t(record.parent) < i);
+        if (!parentOk || record.type < 1 || record.type > 3 ||
+            record.nameOffset >= header.stringPoolSize || record.geoId >= GEO_COUNT)
+        {
+            return Fail("scene file has an invalid node record");
+        }
+    }
+
+    nodes = records;
+    stringPool = reinterpret_cast<const char*>(data + header.stringPoolOffset);
+    nodeCount = header.nodeCount;
+    return true;
+}
+
+const std::string& SceneFile::GetError() const
+{
+    return error;
+}
+
+unsigned int SceneFile::GetNodeCount() const
+{
+    return nodeCount;
+}
+
+const SceneFileNode* SceneFile::GetNodes() const
+{
+    return nodes;
+}
+
+const char* SceneFile::GetName(const SceneFileNode& iNode) const
+{
+    return stringPool + iNode.nameOffset;
+}
+
+Node* SceneFile::Instantiate(NodePool& ioPool) const
+{
+    if (nodeCount == 0)
+    {
+        return nullptr;
+    }
+
+    std::vector<Node*> created(nodeCount);
+    for (unsigned int i = 0; i < nodeCount; i++)
+    {
+        const SceneFileNode& record = nodes[i];
+        Node* node = nullptr;
+        switch (record.type)
+        {
+            case 1: // TranslateNode;
+                node = &ioPool.CreateTranslate(record.params[0], record.params[1], GetName(record), false);
+                break;
+            case 2: // RotateNode;
+                node = &ioPool.CreateRotate(record.params[0], GetName(record), false);
+                break;
+            case 3: // ScaleNode;
+                node = &ioPool.CreateScale(record.params[0], record.params[1], GetName(record), false);
+                break;
+        }
+        node->AddGeo(record.geoId);
+        node->ModifyColor(glm::vec3(record.color[0], record.color[1], record.color[2]));
+        if (record.parent >= 0)
+        {
+            created[record.parent]->AddChild(*node);
+        }
+        created[i] = node;
+    }
+    return created[0];
+}
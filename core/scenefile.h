@@ -0,0 +1,79 @@
+#pragma once
+#include "mappedfile.h"
+#include "node.h"
+#include "nodepool.h"
+#include <cstdint>
+#include <string>
+
+// Binary scene files. The whole file is memory-mapped and its tables are used
+// in place; loading does no parsing and no per-node allocation.
+//
+// Layout, little-endian, every section 8-byte aligned:
+//   SceneFileHeader
+//   SceneFileNode[nodeCount]   at nodeTableOffset
+//   string pool                at stringPoolOffset, 0-terminated node names
+//
+// Records are stored in pre-order. Every record's parent comes before it, and
+// record 0 is the root. Bump SCENE_FILE_VERSION whenever a record changes.
+const std::uint32_t SCENE_FILE_VERSION = 1;
+const char SCENE_FILE_MAGIC[8] = {'S', 'G', 'S', 'C', 'E', 'N', 'E', '\0'};
+
+struct SceneFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t nodeCount;
+    std::uint64_t nodeTableOffset;
+    std::uint64_t stringPoolOffset;
+    std::uint64_t stringPoolSize;
+};
+
+struct SceneFileNode
+{
+    std::uint32_t type;         // Node::GetNodeType(): 1 translate, 2 rotate, 3 scale
+    std::int32_t parent;        // Record index of the parent, -1 for the root
+    float params[2];            // Translate: x, y. Rotate: degrees, 0. Scale: x, y.
+    std::uint32_t nameOffset;   // Into the string pool
+    std::uint32_t geoId;        // GeometryId
+    float color[3];
+};
+
+static_assert(sizeof(SceneFileHeader) == 40, "SceneFileHeader is part of the file format");
+static_assert(sizeof(SceneFileNode) == 36, "SceneFileNode is part of the file format");
+// The tables are used in place, so the host has to share the file's byte order.
+// Compilers that do not say are MSVC, whose targets are all little-endian.
+#if defined(__BYTE_ORDER__)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "scene files are little-endian and mapped in place");
+#endif
+
+// Write the tree under iRoot. Returns false and fills oError if the file cannot be written.
+bool SaveSceneFile(const char* iPath, Node& iRoot, std::string* oError = nullptr);
+
+// A mapped scene file.
+class SceneFile
+{
+public:
+    SceneFile();
+
+    // Map iPath and check the header and that every record stays inside the file.
+    // On failure GetError() says why.
+    bool Open(const char* iPath);
+    const std::string& GetError() const;
+
+    unsigned int GetNodeCount() const;
+    const SceneFileNode* GetNodes() const;
+    const char* GetName(const SceneFileNode& iNode) const;
+
+    // Create the nodes in ioPool and return the root. The names are not copied,
+    // they point into the mapping, so this SceneFile has to outlive the nodes.
+    Node* Instantiate(NodePool& ioPool) const;
+
+private:
+    bool Fail(const char* iReason);
+
+    MappedFile file;
+    const SceneFileNode* nodes;
+    const char* stringPool;
+    unsigned int nodeCount;
+    std::string error;
+};
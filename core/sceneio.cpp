@@ -0,0 +1,48 @@
+#include "sceneio.h"
+#include <cstring>
+
+bool IsTextScene(const char* iPath)
+{
+    size_t length = std::strlen(iPath);
+    return length >= 5 && std::strcmp(iPath + length - 5, ".json") == 0;
+}
+
+bool ReadScene(const char* iPath, LoadedScene& oScene, std::string& oError, SceneImportStats* oStats)
+{
+    // Either way the scene goes into a pool of its own, so a broken file leaves the caller's alone.
+    uPtr<NodePool> pool = mkU<NodePool>();
+    if (IsTextScene(iPath))
+    {
+        Node* root = ImportSceneText(iPath, *pool, oError, oStats);
+        if (root == nullptr)
+        {
+            return false;
+        }
+        oScene.pool = std::move(pool);
+        oScene.file = nullptr;
+        oScene.root = root;
+        return true;
+    }
+
+    uPtr<SceneFile> file = mkU<SceneFile>();
+    if (!file->Open(iPath))
+    {
+        oError = file->GetError();
+        return false;
+    }
+    Node* root = file->Instantiate(*pool);
+    // Any old pool has to go before its file, see LoadedScene.
+    oScene.pool = std::move(pool);
+    oScene.file = std::move(file);
+    oScene.root = root;
+    return true;
+}
+
+bool WriteScene(const char* iPath, Node& iRoot, std::string& oError)
+{
+    if (IsTextScene(iPath))
+    {
+        return SaveSceneText(iPath, iRoot, &oError);
+    }
+    return SaveSceneFile(iPath, iRoot, &oError);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "nodepool.h"
+#include "scenefile.h"
+#include "scenetext.h"
+#include "smartpointerhelp.h"
+#include <string>
+
+// A scene read by ReadScene with everything its nodes depend on. The pool is
+// declared last so it is destroyed first: the nodes of a binary scene borrow
+// their names from the file's mapping.
+struct LoadedScene
+{
+    uPtr<SceneFile> file; // Only set for binary scenes
+    uPtr<NodePool> pool;
+    Node* root = nullptr;
+};
+
+// Files ending in ".json" use the text format (scenetext.h), all others the binary one (scenefile.h).
+bool IsTextScene(const char* iPath);
+
+// Read iPath, in either format, into a new pool. On failure oError says why and
+// oScene is left empty. oStats is only filled for text scenes.
+bool ReadScene(const char* iPath, LoadedScene& oScene, std::string& oError, SceneImportStats* oStats = nullptr);
+
+// Write the tree under iRoot to iPath in the format its name asks for.
+bool WriteScene(const char* iPath, Node& iRoot, std::string& oError);
@@ -0,0 +1,570 @@
+#include "scenetext.h"
+#include "jsonreader.h"
+#include <chrono>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static const char* const NODE_TYPE_NAMES[] = {"translate", "rotate", "scale"};
+static const char* const GEOMETRY_NAMES[GEO_COUNT] = {"none", "rectangle", "circle", "trapezoid", "shoe"};
+
+// The keys of a node object besides "children".
+enum NodeKey
+{
+    NODE_KEY_TYPE,
+    NODE_KEY_NAME,
+    NODE_KEY_X,
+    NODE_KEY_Y,
+    NODE_KEY_DEGREES,
+    NODE_KEY_GEOMETRY,
+    NODE_KEY_COLOR,
+    NODE_KEY_COUNT  // Not a node key
+};
+static const char* const NODE_KEY_NAMES[NODE_KEY_COUNT] = {"type", "name", "x", "y", "degrees", "geometry", "color"};
+
+// A node object that is still open while importing. Its name is not kept
+// here: the node is created before any child object opens, so only the
+// innermost frame can still need one and a single scratch string holds it.
+struct ImportFrame
+{
+    unsigned int type = 0;      // Node::GetNodeType(), 0 until "type" was read
+    float params[2] = {0.f, 0.f};
+    bool hasParam[2] = {false, false};
+    bool hasDegrees = false;
+    GeometryId geoId = GEO_NONE;
+    glm::vec3 color = glm::vec3(0.f);
+    bool hasColor = false;
+    Node* node = nullptr;       // Created on "children" or at the end of the object
+    bool inChildren = false;
+};
+
+// Report iMessage unless iCondition holds or the reader already failed. Returns iCondition.
+static bool Check(JsonReader& ioReader, bool iCondition, const char* iMessage)
+{
+    if (!iCondition && ioReader.GetError().empty())
+    {
+        ioReader.Fail(iMessage);
+    }
+    return iCondition;
+}
+
+// Which parameter keys a node type accepts.
+static bool TakesXY(unsigned int iType)
+{
+    return iType == 1 || iType == 3;
+}
+
+// Apply a parameter read after the node was created.
+static void ApplyParam(Node& ioNode, int iIndex, float iValue)
+{
+    switch (ioNode.GetNodeType())
+    {
+        case 1: // TranslateNode;
+            if (iIndex == 0)
+            {
+                static_cast<TranslateNode&>(ioNode).SetXTranslation(iValue);
+            }
+            else
+            {
+                static_cast<TranslateNode&>(ioNode).SetYTranslation(iValue);
+            }
+            break;
+        case 2: // RotateNode;
+            static_cast<RotateNode&>(ioNode).SetMagnitude(iValue);
+            break;
+        case 3: // ScaleNode;
+            if (iIndex == 0)
+            {
+                static_cast<ScaleNode&>(ioNode).SetXScalar(iValue);
+            }
+            else
+            {
+                static_cast<ScaleNode&>(ioNode).SetYScalar(iValue);
+            }
+            break;
+    }
+}
+
+// Create the node of ioFrame, named iName, under iParent. Returns an error message or nullptr.
+static const char* CreateNode(ImportFrame& ioFrame, const std::string& iName, Node* iParent, NodePool& ioPool)
+{
+    if (ioFrame.type == 0)
+    {
+        return "node has no \"type\"";
+    }
+    if ((ioFrame.hasParam[0] || ioFrame.hasParam[1]) && !TakesXY(ioFrame.type))
+    {
+        return "\"x\" and \"y\" are only valid for translate and scale nodes";
+    }
+    if (ioFrame.hasDegrees && ioFrame.type != 2)
+    {
+        return "\"degrees\" is only valid for rotate nodes";
+    }
+
+    Node* node = nullptr;
+    switch (ioFrame.type)
+    {
+        case 1: // TranslateNode;
+            node = &ioPool.CreateTranslate(ioFrame.params[0], ioFrame.params[1], iName.c_str());
+            break;
+        case 2: // RotateNode;
+            node = &ioPool.CreateRotate(ioFrame.params[0], iName.c_str());
+            break;
+        case 3: // ScaleNode;
+            node = &ioPool.CreateScale(ioFrame.hasParam[0] ? ioFrame.params[0] : 1.f,
+                                       ioFrame.hasParam[1] ? ioFrame.params[1] : 1.f, iName.c_str());
+            break;
+    }
+    node->AddGeo(ioFrame.geoId);
+    if (ioFrame.hasColor)
+    {
+        node->ModifyColor(ioFrame.color);
+    }
+    if (iParent != nullptr)
+    {
+        iParent->AddChild(*node);
+    }
+    ioFrame.node = node;
+    return nullptr;
+}
+
+static NodeKey FindNodeKey(const std::string& iKey)
+{
+    int key = 0;
+    while (key < NODE_KEY_COUNT && iKey != NODE_KEY_NAMES[key])
+    {
+        key++;
+    }
+    return static_cast<NodeKey>(key);
+}
+
+// Read the value of one node key into ioFrame and ioName, or straight into its
+// node once that exists. Returns false after reporting the error through ioReader.
+static bool ReadNodeKey(JsonReader& ioReader, NodeKey iKey, ImportFrame& ioFrame, std::string& ioName)
+{
+    if (iKey == NODE_KEY_COUNT)
+    {
+        ioReader.Fail("unknown node key");
+        return false;
+    }
+    JsonEvent event = ioReader.Next();
+    if (event == JSON_ERROR)
+    {
+        return false;
+    }
+
+    if (iKey == NODE_KEY_TYPE || iKey == NODE_KEY_NAME)
+    {
+        if (event != JSON_STRING)
+        {
+            ioReader.Fail("expected a string");
+            return false;
+        }
+        if (ioFrame.node != nullptr)
+        {
+            ioReader.Fail("\"type\" and \"name\" have to come before \"children\"");
+            return false;
+        }
+        if (iKey == NODE_KEY_NAME)
+        {
+            ioName.assign(ioReader.GetString());
+            return true;
+        }
+        for (unsigned int t = 0; t < 3; t++)
+        {
+            if (ioReader.GetString() == NODE_TYPE_NAMES[t])
+            {
+                ioFrame.type = t + 1;
+                return true;
+            }
+        }
+        ioReader.Fail("unknown node type");
+        return false;
+    }
+
+    if (iKey == NODE_KEY_X || iKey == NODE_KEY_Y || iKey == NODE_KEY_DEGREES)
+    {
+        if (event != JSON_NUMBER)
+        {
+            ioReader.Fail("expected a number");
+            return false;
+        }
+        int index = iKey == NODE_KEY_Y ? 1 : 0;
+        bool degrees = iKey == NODE_KEY_DEGREES;
+        float value = static_cast<float>(ioReader.GetNumber());
+        if (ioFrame.node == nullptr)
+        {
+            ioFrame.params[index] = value;
+            ioFrame.hasParam[index] = ioFrame.hasParam[index] || !degrees;
+            ioFrame.hasDegrees = ioFrame.hasDegrees || degrees;
+            return true;
+        }
+        if (degrees ? ioFrame.type != 2 : !TakesXY(ioFrame.type))
+        {
+            ioReader.Fail(degrees ? "\"degrees\" is only valid for rotate nodes"
+                                  : "\"x\" and \"y\" are only valid for translate and scale nodes");
+            return false;
+        }
+        ApplyParam(*ioFrame.node, index, value);
+        return true;
+    }
+
+    if (iKey == NODE_KEY_GEOMETRY)
+    {
+        if (event != JSON_STRING)
+        {
+            ioReader.Fail("expected a string");
+            return false;
+        }
+        for (GeometryId g = 0; g < GEO_COUNT; g++)
+        {
+            if (ioReader.GetString() == GEOMETRY_NAMES[g])
+            {
+                ioFrame.geoId = g;
+                if (ioFrame.node != nullptr)
+                {
+                    ioFrame.node->AddGeo(g);
+                }
+                return true;
+            }
+        }
+        ioReader.Fail("unknown geometry");
+        return false;
+    }
+
+    // "color"
+    if (event != JSON_BEGIN_ARRAY)
+    {
+        ioReader.Fail("expected [r, g, b]");
+        return false;
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        if (!Check(ioReader, ioReader.Next() == JSON_NUMBER, "expected [r, g, b]"))
+        {
+            return false;
+        }
+        ioFrame.color[c] = static_cast<float>(ioReader.GetNumber());
+    }
+    if (!Check(ioReader, ioReader.Next() == JSON_END_ARRAY, "expected [r, g, b]"))
+    {
+        return false;
+    }
+    ioFrame.hasColor = true;
+    if (ioFrame.node != nullptr)
+    {
+        ioFrame.node->ModifyColor(ioFrame.color);
+    }
+    return true;
+}
+
+Node* ImportSceneText(const char* iPath, NodePool& ioPool, std::string& oError, SceneImportStats* oStats)
+{
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    Clock::duration buildTime = Clock::duration::zero();
+
+    FILE* in = std::fopen(iPath, "rb");
+    if (in == nullptr)
+    {
+        oError = std::string("cannot open ") + iPath;
+        return nullptr;
+    }
+
+    JsonReader reader(in);
+    Node* root = nullptr;
+    unsigned int nodeCount = 0;
+    bool hasFormat = false;
+    bool ok = Check(reader, reader.Next() == JSON_BEGIN_OBJECT, "expected the scene object");
+
+    // The document object. Nodes are read with an explicit stack of open
+    // objects, so the nesting depth of the scene does not touch the call stack.
+    // The reader reuses its string for every key and value. Node keys are
+    // looked up before the reader moves on; the document keys and the node
+    // names are copied into scratch strings that keep their capacity.
+    std::vector<ImportFrame> stack;
+    std::string key;
+    std::string name;
+    while (ok)
+    {
+        JsonEvent event = reader.Next();
+        if (event == JSON_END_OBJECT)
+        {
+            break;
+        }
+        if (event != JSON_KEY)
+        {
+            ok = false;
+            break;
+        }
+        key.assign(reader.GetString());
+        event = reader.Next();
+        if (key == "format")
+        {
+            ok = Check(reader, event == JSON_STRING && reader.GetString() == "scenegraph", "not a scene document");
+            hasFormat = ok;
+            continue;
+        }
+        if (key == "version")
+        {
+            ok = Check(reader, event == JSON_NUMBER && reader.GetNumber() == SCENE_TEXT_VERSION, "unsupported scene version");
+            continue;
+        }
+        if (key != "root" || root != nullptr)
+        {
+            ok = Check(reader, false, key == "root" ? "more than one root" : "unknown key");
+            continue;
+        }
+        if (event != JSON_BEGIN_OBJECT)
+        {
+            ok = Check(reader, false, "expected a node object");
+            continue;
+        }
+
+        stack.push_back(ImportFrame());
+        name.clear();
+        while (ok && !stack.empty())
+        {
+            ImportFrame& frame = stack.back();
+            event = reader.Next();
+            if (frame.inChildren)
+            {
+                if (event == JSON_BEGIN_OBJECT)
+                {
+                    stack.push_back(ImportFrame());
+                    name.clear();
+                }
+                else if (event == JSON_END_ARRAY)
+                {
+                    frame.inChildren = false;
+                }
+                else
+                {
+                    ok = Check(reader, false, "expected a node object");
+                }
+                continue;
+            }
+
+            if (event == JSON_END_OBJECT || (event == JSON_KEY && reader.GetString() == "children"))
+            {
+                if (frame.node == nullptr)
+                {
+                    Clock::time_point buildStart = Clock::now();
+                    Node* parent = stack.size() > 1 ? stack[stack.size() - 2].node : nullptr;
+                    const char* problem = CreateNode(frame, name, parent, ioPool);
+                    buildTime += Clock::now() - buildStart;
+                    if (problem != nullptr)
+                    {
+                        ok = Check(reader, false, problem);
+                        continue;
+                    }
+                    nodeCount++;
+                    if (parent == nullptr)
+                    {
+                        root = frame.node;
+                    }
+                }
+                if (event == JSON_END_OBJECT)
+                {
+                    stack.pop_back();
+                    continue;
+                }
+                event = reader.Next();
+                ok = Check(reader, event == JSON_BEGIN_ARRAY, "expected an array of nodes");
+                frame.inChildren = true;
+                continue;
+            }
+            ok = Check(reader, event == JSON_KEY, "expected a key") &&
+                 ReadNodeKey(reader, FindNodeKey(reader.GetString()), frame, name);
+        }
+    }
+    if (ok && (!hasFormat || root == nullptr))
+    {
+        ok = Check(reader, false, hasFormat ? "the scene has no \"root\"" : "the scene has no \"format\"");
+    }
+    ok = ok && Check(reader, reader.Next() == JSON_END, "unexpected data after the scene");
+    std::fclose(in);
+
+    if (!ok)
+    {
+        oError = reader.GetError();
+        if (root != nullptr)
+        {
+            ioPool.DestroySubtree(*root);
+        }
+        return nullptr;
+    }
+
+    if (oStats != nullptr)
+    {
+        double total = std::chrono::duration<double>(Clock::now() - start).count();
+        oStats->bytes = reader.GetBytesRead();
+        oStats->nodes = nodeCount;
+        oStats->buildSeconds = std::chrono::duration<double>(buildTime).count();
+        oStats->parseSeconds = total - oStats->buildSeconds;
+    }
+    return root;
+}
+
+// printf follows the C locale, which Qt sets to the user's; JSON wants a '.'.
+// JSON has no infinities or NaNs: those are refused and nothing is written.
+static bool WriteNumber(FILE* iOut, float iValue)
+{
+    if (!std::isfinite(iValue))
+    {
+        return false;
+    }
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.9g", double(iValue));
+    char point = *std::localeconv()->decimal_point;
+    for (char* c = text; *c != '\0'; c++)
+    {
+        if (*c == point)
+        {
+            *c = '.';
+        }
+    }
+    std::fputs(text, iOut);
+    return true;
+}
+
+static void WriteString(FILE* iOut, const char* iText)
+{
+    std::fputc('"', iOut);
+    for (const char* c = iText; *c != '\0'; c++)
+    {
+        unsigned char u = static_cast<unsigned char>(*c);
+        if (u == '"' || u == '\\')
+        {
+            std::fputc('\\', iOut);
+            std::fputc(u, iOut);
+        }
+        else if (u < 0x20)
+        {
+            std::fprintf(iOut, "\\u%04x", u);
+        }
+        else
+        {
+            std::fputc(u, iOut);
+        }
+    }
+    std::fputc('"', iOut);
+}
+
+// Indentation stops growing after a while, so deep chains stay linear in size.
+static void WriteIndent(FILE* iOut, int iDepth)
+{
+    for (int i = 0; i < iDepth && i < 32; i++)
+    {
+        std::fputs("  ", iOut);
+    }
+}
+
+// Returns false if a value of iNode cannot be written as a JSON number.
+static bool WriteNodeFields(FILE* iOut, Node& iNode)
+{
+    unsigned int type = iNode.GetNodeType();
+    bool ok = true;
+    std::fprintf(iOut, "{\"type\": \"%s\", \"name\": ", NODE_TYPE_NAMES[type - 1]);
+    WriteString(iOut, iNode.GetName());
+    switch (type)
+    {
+        case 1: // TranslateNode;
+            std::fputs(", \"x\": ", iOut);
+            ok = ok && WriteNumber(iOut, static_cast<TranslateNode&>(iNode).GetXTranslation());
+            std::fputs(", \"y\": ", iOut);
+            ok = ok && WriteNumber(iOut, static_cast<TranslateNode&>(iNode).GetYTranslation());
+            break;
+        case 2: // RotateNode;
+            std::fputs(", \"degrees\": ", iOut);
+            ok = ok && WriteNumber(iOut, static_cast<RotateNode&>(iNode).GetMagnitude());
+            break;
+        case 3: // ScaleNode;
+            std::fputs(", \"x\": ", iOut);
+            ok = ok && WriteNumber(iOut, static_cast<ScaleNode&>(iNode).GetXScalar());
+            std::fputs(", \"y\": ", iOut);
+            ok = ok && WriteNumber(iOut, static_cast<ScaleNode&>(iNode).GetYScalar());
+            break;
+    }
+    if (iNode.GetGeoId() != GEO_NONE)
+    {
+        std::fprintf(iOut, ", \"geometry\": \"%s\"", GEOMETRY_NAMES[iNode.GetGeoId()]);
+    }
+    glm::vec3 color = iNode.GetColor();
+    std::fputs(", \"color\": [", iOut);
+    ok = ok && WriteNumber(iOut, color.r);
+    std::fputs(", ", iOut);
+    ok = ok && WriteNumber(iOut, color.g);
+    std::fputs(", ", iOut);
+    ok = ok && WriteNumber(iOut, color.b);
+    std::fputc(']', iOut);
+    return ok;
+}
+
+bool SaveSceneText(const char* iPath, Node& iRoot, std::string* oError)
+{
+    FILE* out = std::fopen(iPath, "wb");
+    if (out == nullptr)
+    {
+        if (oError != nullptr)
+        {
+            *oError = std::string("cannot open ") + iPath + " for writing";
+        }
+        return false;
+    }
+
+    std::fprintf(out, "{\n  \"format\": \"scenegraph\",\n  \"version\": %d,\n  \"root\":\n", SCENE_TEXT_VERSION);
+    // Same pre-order walk as SaveSceneFile(), one node per line.
+    Node* current = &iRoot;
+    int depth = 0;
+    while (current != nullptr)
+    {
+        WriteIndent(out, depth + 1);
+        if (!WriteNodeFields(out, *current))
+        {
+            std::fclose(out);
+            std::remove(iPath);
+            if (oError != nullptr)
+            {
+                *oError = std::string("node \"") + current->GetName() + "\" has a value that is not a finite number";
+            }
+            return false;
+        }
+        if (current->GetFirstChild() != nullptr)
+        {
+            std::fputs(", \"children\": [\n", out);
+            depth++;
+            current = current->GetFirstChild();
+            continue;
+        }
+        std::fputc('}', out);
+        while (current != &iRoot && current->GetNextSibling() == nullptr)
+        {
+            current = current->GetParent();
+            depth--;
+            std::fputc('\n', out);
+            WriteIndent(out, depth + 1);
+            std::fputs("]}", out);
+        }
+        if (current != &iRoot)
+        {
+            std::fputs(",\n", out);
+            current = current->GetNextSibling();
+        }
+        else
+        {
+            current = nullptr;
+        }
+    }
+    std::fputs("\n}\n", out);
+
+    bool ok = std::ferror(out) == 0;
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok && oError != nullptr)
+    {
+        *oError = std::string("cannot write ") + iPath;
+    }
+    return ok;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "node.h"
+#include "nodepool.h"
+#include <string>
+
+// Human-editable JSON scene description:
+//
+//   {
+//     "format": "scenegraph", "version": 1,
+//     "root": {
+//       "type": "translate", "name": "Root", "x": 0, "y": 0,
+//       "children": [
+//         { "type": "rotate", "name": "arm R", "degrees": 30,
+//           "children": [
+//             { "type": "scale", "name": "arm S", "x": 0.5, "y": 2,
+//               "geometry": "rectangle", "color": [1, 0.5, 0] }
+//           ] }
+//       ]
+//     }
+//   }
+//
+// Node keys: "type" ("translate", "rotate" or "scale"), "name", "x" and "y"
+// (translate, scale), "degrees" (rotate), "geometry" ("none", "rectangle",
+// "circle", "trapezoid", "shoe"), "color" ([r, g, b]) and "children".
+// A node is created as soon as its "children" key or its end is reached, so
+// "type" and "name" have to come before "children"; everything else may
+// follow it. Unknown keys are errors, so typos do not go unnoticed.
+
+const int SCENE_TEXT_VERSION = 1;
+
+// Time spent in each phase of an import. Parsing and node building are
+// interleaved; buildSeconds is measured around the node creation calls and
+// parseSeconds is the rest.
+struct SceneImportStats
+{
+    unsigned long long bytes = 0;
+    unsigned int nodes = 0;
+    double parseSeconds = 0.0;
+    double buildSeconds = 0.0;
+};
+
+// Stream iPath into nodes in ioPool and return the root. On failure returns
+// nullptr, sets oError to "line:column: message" and destroys what was built.
+Node* ImportSceneText(const char* iPath, NodePool& ioPool, std::string& oError, SceneImportStats* oStats = nullptr);
+
+// Write the tree under iRoot in the format above. JSON has no infinities or
+// NaNs, so a node holding one makes this fail and no file is left behind.
+bool SaveSceneText(const char* iPath, Node& iRoot, std::string* oError = nullptr);
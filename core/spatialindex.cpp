@@ -0,0 +1,341 @@
+#include "spatialindex.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+// Half the perimeter of iBox, the 2D counterpart of surface area in the cost
+// of a bounding volume hierarchy.
+static float HalfPerimeter(const Aabb2& iBox)
+{
+    if (iBox.IsEmpty())
+    {
+        return 0.f;
+    }
+    return (iBox.max.x - iBox.min.x) + (iBox.max.y - iBox.min.y);
+}
+
+static float DistanceSquared(const Aabb2& iBox, glm::vec2 iPoint)
+{
+    glm::vec2 d = glm::max(glm::max(iBox.min - iPoint, iPoint - iBox.max), glm::vec2(0.f));
+    return d.x * d.x + d.y * d.y;
+}
+
+static bool Contains(const Aabb2& iBox, glm::vec2 iPoint)
+{
+    return iBox.min.x <= iPoint.x && iPoint.x <= iBox.max.x &&
+           iBox.min.y <= iPoint.y && iPoint.y <= iBox.max.y;
+}
+
+SpatialIndex::SpatialIndex()
+{}
+
+void SpatialIndex::Clear()
+{
+    nodes.clear();
+    slotItem.clear();
+    slotBox.clear();
+    itemSlot.clear();
+    slotLeaf.clear();
+    nodeDirty.clear();
+    dirtyNodes.clear();
+    stats = SpatialIndexStats();
+}
+
+bool SpatialIndex::IsBuilt() const
+{
+    return !nodes.empty();
+}
+
+void SpatialIndex::Build(const std::vector<Aabb2>& iBounds, const std::vector<int>& iItems)
+{
+    // The split only permutes buildOrder; slots are laid out in leaf order
+    // once the tree is done.
+    int count = static_cast<int>(iItems.size());
+    slotBox.resize(count);
+    centroid.resize(count);
+    buildOrder.resize(count);
+    for (int k = 0; k < count; k++)
+    {
+        slotBox[k] = iBounds[iItems[k]];
+        centroid[k] = (slotBox[k].min + slotBox[k].max) * 0.5f;
+        buildOrder[k] = k;
+    }
+
+    nodes.clear();
+    if (count > 0)
+    {
+        // Leaves hold at least LEAF_SIZE / 2 items, so a binary tree over them
+        // has fewer than 4 * count / LEAF_SIZE nodes.
+        nodes.reserve(4 * count / LEAF_SIZE + 1);
+        nodes.push_back(TreeNode());
+        BuildNode(0, -1, 0, count);
+    }
+
+    std::vector<Aabb2> boxes(count);
+    slotItem.resize(count);
+    for (int s = 0; s < count; s++)
+    {
+        slotItem[s] = iItems[buildOrder[s]];
+        boxes[s] = slotBox[buildOrder[s]];
+    }
+    slotBox.swap(boxes);
+    itemSlot.assign(iBounds.size(), -1);
+    for (int s = 0; s < count; s++)
+    {
+        itemSlot[slotItem[s]] = s;
+    }
+    slotLeaf.resize(count);
+    stats.cost = 0.f;
+    for (int n = 0; n < static_cast<int>(nodes.size()); n++)
+    {
+        const TreeNode& node = nodes[n];
+        for (int s = node.first; s < node.first + node.count; s++)
+        {
+            slotLeaf[s] = n;
+        }
+        stats.cost += HalfPerimeter(node.box);
+    }
+    nodeDirty.assign(nodes.size(), 0);
+    stats.builds++;
+    stats.treeNodes = static_cast<unsigned int>(nodes.size());
+    stats.builtCost = stats.cost;
+}
+
+void SpatialIndex::BuildNode(int iNode, int iParent, int iBegin, int iEnd)
+{
+    Aabb2 box = Aabb2::Empty();
+    Aabb2 centers = Aabb2::Empty();
+    for (int s = iBegin; s < iEnd; s++)
+    {
+        int k = buildOrder[s];
+        box.Include(slotBox[k]);
+        centers.Include(Aabb2{centroid[k], centroid[k]});
+    }
+    TreeNode node = {box, iBegin, iEnd - iBegin, iParent};
+    if (iEnd - iBegin <= LEAF_SIZE)
+    {
+        nodes[iNode] = node;
+        return;
+    }
+
+    // Split at the median centroid along the longer side of the centroids'
+    // box. Both children are allocated before either subtree, so they are
+    // adjacent and come after their parent.
+    glm::vec2 extent = centers.max - centers.min;
+    int axis = extent.x >= extent.y ? 0 : 1;
+    int middle = iBegin + (iEnd - iBegin) / 2;
+    std::nth_element(buildOrder.begin() + iBegin, buildOrder.begin() + middle, buildOrder.begin() + iEnd,
+                     [&](int a, int b) { return centroid[a][axis] < centroid[b][axis]; });
+    int left = static_cast<int>(nodes.size());
+    nodes.resize(left + 2);
+    node.first = left;
+    node.count = 0;
+    nodes[iNode] = node;
+    BuildNode(left, iNode, iBegin, middle);
+    BuildNode(left + 1, iNode, middle, iEnd);
+}
+
+void SpatialIndex::Rebuild(const std::vector<Aabb2>& iBounds)
+{
+    std::vector<int> items = slotItem;
+    Build(iBounds, items);
+}
+
+void SpatialIndex::Refit(const std::vector<Aabb2>& iBounds, const std::vector<int>& iMoved)
+{
+    // Mark the leaves of the moved items and their ancestors, stopping at the
+    // first one that is already marked. Children come after their parent, so
+    // updating in decreasing order finishes every child before its parent.
+    dirtyNodes.clear();
+    for (int item : iMoved)
+    {
+        if (item < 0 || item >= static_cast<int>(itemSlot.size()) || itemSlot[item] < 0)
+        {
+            continue;
+        }
+        int slot = itemSlot[item];
+        slotBox[slot] = iBounds[item];
+        for (int n = slotLeaf[slot]; n >= 0 && !nodeDirty[n]; n = nodes[n].parent)
+        {
+            nodeDirty[n] = 1;
+            dirtyNodes.push_back(n);
+        }
+    }
+    std::sort(dirtyNodes.begin(), dirtyNodes.end(), std::greater<int>());
+    for (int n : dirtyNodes)
+    {
+        UpdateBox(n);
+        nodeDirty[n] = 0;
+    }
+    stats.refits++;
+}
+
+void SpatialIndex::UpdateBox(int iNode)
+{
+    TreeNode& node = nodes[iNode];
+    Aabb2 box = Aabb2::Empty();
+    if (node.count > 0)
+    {
+        for (int s = node.first; s < node.first + node.count; s++)
+        {
+            box.Include(slotBox[s]);
+        }
+    }
+    else
+    {
+        box = nodes[node.first].box;
+        box.Include(nodes[node.first + 1].box);
+    }
+    stats.cost += HalfPerimeter(box) - HalfPerimeter(node.box);
+    node.box = box;
+}
+
+bool SpatialIndex::Update(const std::vector<Aabb2>& iBounds, const std::vector<int>& iMoved)
+{
+    if (iMoved.empty())
+    {
+        return false;
+    }
+    if (static_cast<float>(iMoved.size()) > REBUILD_FRACTION * static_cast<float>(slotItem.size()))
+    {
+        Rebuild(iBounds);
+        return true;
+    }
+    Refit(iBounds, iMoved);
+    if (stats.cost > REBUILD_COST_RATIO * stats.builtCost)
+    {
+        Rebuild(iBounds);
+        return true;
+    }
+    return false;
+}
+
+void SpatialIndex::QueryPoint(glm::vec2 iPoint, std::vector<int>& oItems) const
+{
+    oItems.clear();
+    if (nodes.empty())
+    {
+        return;
+    }
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const TreeNode& node = nodes[stack[--top]];
+        if (!Contains(node.box, iPoint))
+        {
+            continue;
+        }
+        if (node.count > 0)
+        {
+            for (int s = node.first; s < node.first + node.count; s++)
+            {
+                if (Contains(slotBox[s], iPoint))
+                {
+                    oItems.push_back(slotItem[s]);
+                }
+            }
+        }
+        else
+        {
+            stack[top++] = node.first;
+            stack[top++] = node.first + 1;
+        }
+    }
+}
+
+void SpatialIndex::QueryRect(const Aabb2& iRect, std::vector<int>& oItems) const
+{
+    oItems.clear();
+    if (nodes.empty())
+    {
+        return;
+    }
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const TreeNode& node = nodes[stack[--top]];
+        if (!node.box.Intersects(iRect))
+        {
+            continue;
+        }
+        if (node.count > 0)
+        {
+            for (int s = node.first; s < node.first + node.count; s++)
+            {
+                if (slotBox[s].Intersects(iRect))
+                {
+                    oItems.push_back(slotItem[s]);
+                }
+            }
+        }
+        else
+        {
+            stack[top++] = node.first;
+            stack[top++] = node.first + 1;
+        }
+    }
+}
+
+void SpatialIndex::QueryNearest(glm::vec2 iPoint, int iCount, std::vector<int>& oItems) const
+{
+    oItems.clear();
+    if (nodes.empty() || iCount <= 0)
+    {
+        return;
+    }
+    // Best first: tree nodes come off the queue nearest first, and the search
+    // ends when the nearest one left is no nearer than the iCount-th best item.
+    typedef std::pair<float, int> Candidate;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > open;
+    std::priority_queue<Candidate> best; // Worst of the best on top
+    open.push(Candidate(DistanceSquared(nodes[0].box, iPoint), 0));
+    while (!open.empty())
+    {
+        Candidate next = open.top();
+        open.pop();
+        if (static_cast<int>(best.size()) == iCount && next.first >= best.top().first)
+        {
+            break;
+        }
+        const TreeNode& node = nodes[next.second];
+        if (node.count > 0)
+        {
+            for (int s = node.first; s < node.first + node.count; s++)
+            {
+                Candidate item(DistanceSquared(slotBox[s], iPoint), slotItem[s]);
+                if (static_cast<int>(best.size()) < iCount)
+                {
+                    best.push(item);
+                }
+                else if (item < best.top())
+                {
+                    best.pop();
+                    best.push(item);
+                }
+            }
+        }
+        else
+        {
+            for (int c = node.first; c < node.first + 2; c++)
+            {
+                open.push(Candidate(DistanceSquared(nodes[c].box, iPoint), c));
+            }
+        }
+    }
+    oItems.resize(best.size());
+    for (int k = static_cast<int>(best.size()) - 1; k >= 0; k--)
+    {
+        oItems[k] = best.top().second;
+        best.pop();
+    }
+}
+
+const SpatialIndexStats& SpatialIndex::GetStats() const
+{
+    return stats;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "aabb2.h"
+#include <vector>
+
+// How the index was maintained so far.
+struct SpatialIndexStats
+{
+    unsigned int builds = 0;   // Full builds, including rebuilds
+    unsigned int refits = 0;
+    unsigned int treeNodes = 0;
+    float cost = 0.f;          // Sum of the half perimeters of all tree node boxes
+    float builtCost = 0.f;     // The same right after the last build
+};
+
+// A bounding volume hierarchy over the boxes of a set of items, e.g. the
+// entries of a TransformHierarchy that carry geometry, indexed by item number.
+// Built top-down by splitting at the median centroid along the longer axis.
+// When items move, Refit() only recomputes the boxes above them; Update()
+// decides between refitting and rebuilding: a rebuild is cheaper once a large
+// part of the items moved, and needed once refitting has made the boxes
+// overlap so much that queries visit far more of the tree than after a build.
+class SpatialIndex
+{
+public:
+    static const int LEAF_SIZE = 4;
+    // Update() rebuilds when more than this fraction of the items moved...
+    static constexpr float REBUILD_FRACTION = 0.25f;
+    // ...or when refitting has raised the cost this much above the built tree's.
+    static constexpr float REBUILD_COST_RATIO = 1.5f;
+
+    SpatialIndex();
+
+    void Clear();
+    bool IsBuilt() const;
+    // Index iItems, whose boxes are iBounds[item].
+    void Build(const std::vector<Aabb2>& iBounds, const std::vector<int>& iItems);
+    // The items in iMoved have new boxes in iBounds. Returns true if it rebuilt.
+    bool Update(const std::vector<Aabb2>& iBounds, const std::vector<int>& iMoved);
+    // Recompute the boxes of the tree nodes above the iMoved items, leaving
+    // the tree's structure as it is.
+    void Refit(const std::vector<Aabb2>& iBounds, const std::vector<int>& iMoved);
+    // Build the same items again from their boxes in iBounds.
+    void Rebuild(const std::vector<Aabb2>& iBounds);
+
+    // The items whose box contains iPoint, or intersects iRect, in no particular order.
+    void QueryPoint(glm::vec2 iPoint, std::vector<int>& oItems) const;
+    void QueryRect(const Aabb2& iRect, std::vector<int>& oItems) const;
+    // The iCount items whose boxes are nearest to iPoint, nearest first. A box
+    // that contains iPoint is at distance 0.
+    void QueryNearest(glm::vec2 iPoint, int iCount, std::vector<int>& oItems) const;
+
+    const SpatialIndexStats& GetStats() const;
+
+private:
+    // An inner node has count 0 and its children at first and first + 1; a
+    // leaf holds the items in slots [first, first + count). Children always
+    // come after their parent.
+    struct TreeNode
+    {
+        Aabb2 box;
+        int first;
+        int count;
+        int parent;
+    };
+
+    // Fill nodes[iNode] with the slots [iBegin, iEnd) of buildOrder.
+    void BuildNode(int iNode, int iParent, int iBegin, int iEnd);
+    void UpdateBox(int iNode);
+
+    std::vector<TreeNode> nodes;
+    std::vector<int> slotItem;     // The item in each slot, grouped by leaf
+    std::vector<Aabb2> slotBox;    // Its box, next to its neighbours for the queries
+    std::vector<int> itemSlot;     // Inverse of slotItem; -1 for items not indexed
+    std::vector<int> slotLeaf;     // The leaf holding each slot
+    std::vector<unsigned char> nodeDirty;
+    std::vector<int> dirtyNodes;
+    std::vector<glm::vec2> centroid; // Scratch of Build(), per item in input order
+    std::vector<int> buildOrder;
+    SpatialIndexStats stats;
+};
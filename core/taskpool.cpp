@@ -0,0 +1,159 @@
+#include "taskpool.h"
+
+// Index of the calling thread's queue; worker 0 is whoever called Run().
+static thread_local int currentWorker = 0;
+
+TaskPool::TaskPool(int iThreadCount)
+    : pending(0), active(false), stopping(false)
+{
+    StartWorkers(iThreadCount);
+}
+
+TaskPool::~TaskPool()
+{
+    StopWorkers();
+}
+
+void TaskPool::SetThreadCount(int iThreadCount)
+{
+    StopWorkers();
+    StartWorkers(iThreadCount);
+}
+
+int TaskPool::GetThreadCount() const
+{
+    return static_cast<int>(queues.size());
+}
+
+void TaskPool::StartWorkers(int iThreadCount)
+{
+    if (iThreadCount <= 0)
+    {
+        iThreadCount = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    if (iThreadCount <= 0)
+    {
+        iThreadCount = 1;
+    }
+
+    stopping = false;
+    for (int i = 0; i < iThreadCount; i++)
+    {
+        queues.push_back(mkU<Queue>());
+    }
+    for (int i = 1; i < iThreadCount; i++)
+    {
+        threads.push_back(std::thread(&TaskPool::WorkerLoop, this, i));
+    }
+}
+
+void TaskPool::StopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> guard(wakeLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::vector<std::thread>::iterator p = threads.begin(); p != threads.end(); p++)
+    {
+        p->join();
+    }
+    threads.clear();
+    queues.clear();
+}
+
+void TaskPool::Run(TaskFunction iFunction, void* iContext, int iBegin, int iEnd)
+{
+    currentWorker = 0;
+    pending = 1;
+    {
+        std::lock_guard<std::mutex> guard(queues[0]->lock);
+        Task task = {iFunction, iContext, iBegin, iEnd};
+        queues[0]->tasks.push_back(task);
+    }
+    {
+        std::lock_guard<std::mutex> guard(wakeLock);
+        active = true;
+    }
+    wake.notify_all();
+
+    while (pending > 0)
+    {
+        if (!TryRunOne(0))
+        {
+            std::this_thread::yield();
+        }
+    }
+    active = false;
+}
+
+void TaskPool::Spawn(TaskFunction iFunction, void* iContext, int iBegin, int iEnd)
+{
+    pending++;
+    Queue& queue = *queues[currentWorker];
+    std::lock_guard<std::mutex> guard(queue.lock);
+    Task task = {iFunction, iContext, iBegin, iEnd};
+    queue.tasks.push_back(task);
+}
+
+void TaskPool::WorkerLoop(int iWorker)
+{
+    currentWorker = iWorker;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> guard(wakeLock);
+            wake.wait(guard, [this]{ return stopping || active; });
+            if (stopping)
+            {
+                return;
+            }
+        }
+        // Spin while the job lasts; going back to sleep between tasks costs more than it saves.
+        while (active)
+        {
+            if (!TryRunOne(iWorker))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+bool TaskPool::TryRunOne(int iWorker)
+{
+    Task task = {nullptr, nullptr, 0, 0};
+    bool found = false;
+    {
+        Queue& own = *queues[iWorker];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty())
+        {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+
+    int count = static_cast<int>(queues.size());
+    for (int k = 1; k < count && !found; k++)
+    {
+        Queue& victim = *queues[(iWorker + k) % count];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            // Steal the oldest task: it is the biggest piece of work in that queue.
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found)
+    {
+        return false;
+    }
+    task.function(*this, task.context, task.begin, task.end);
+    pending--;
+    return true;
+}
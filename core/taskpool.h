@@ -0,0 +1,64 @@
+#pragma once
+#include "smartpointerhelp.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A small work-stealing thread pool for fork/join style jobs.
+// Every worker owns a deque of tasks: it pushes and pops at the back, idle
+// workers steal from the front of the others. The thread that calls Run()
+// takes part as worker 0, so a pool of N threads starts N - 1 of its own.
+// Tasks are plain function pointers with a context and an index range, so
+// spawning one only queues three words.
+class TaskPool
+{
+public:
+    typedef void (*TaskFunction)(TaskPool& ioPool, void* iContext, int iBegin, int iEnd);
+
+    // iThreadCount <= 0 uses one thread per hardware thread.
+    explicit TaskPool(int iThreadCount = 0);
+    ~TaskPool();
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    // Restart the workers with a different thread count; not while Run() is active.
+    void SetThreadCount(int iThreadCount);
+    int GetThreadCount() const;
+
+    // Run iFunction on [iBegin, iEnd) and everything it spawns; returns once all of it has finished.
+    void Run(TaskFunction iFunction, void* iContext, int iBegin, int iEnd);
+    // Queue another task of the current Run(). Only valid from inside a task.
+    void Spawn(TaskFunction iFunction, void* iContext, int iBegin, int iEnd);
+
+private:
+    struct Task
+    {
+        TaskFunction function;
+        void* context;
+        int begin;
+        int end;
+    };
+
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    void StartWorkers(int iThreadCount);
+    void StopWorkers();
+    void WorkerLoop(int iWorker);
+    // Run one task from iWorker's own queue or, failing that, a stolen one.
+    bool TryRunOne(int iWorker);
+
+    std::vector<uPtr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<int> pending;   // Tasks spawned in the current Run() that have not finished.
+    std::atomic<bool> active;   // True while a Run() is in progress.
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    bool stopping;
+};
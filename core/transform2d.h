@@ -0,0 +1,178 @@
+#pragma once
+#include "affine2x3.h"
+#include "coremath.h"
+#include <cmath>
+
+// Kinds of local transformation. The first three match Node::GetNodeType().
+const unsigned char TRANSFORM_TRANSLATE = 1;
+const unsigned char TRANSFORM_ROTATE = 2;
+const unsigned char TRANSFORM_SCALE = 3;
+const unsigned char TRANSFORM_AFFINE = 4;
+
+// A compact tagged local transformation. Only as many floats as the kind
+// needs are meaningful:
+//   translate - (x, y)
+//   rotate    - (cos, sin) of the angle
+//   scale     - (x, y)
+//   affine    - an Affine2x3
+struct Transform2D
+{
+    unsigned char kind;
+    float data[6];
+
+    static Transform2D Translate(float ix, float iy)
+    {
+        Transform2D t = {TRANSFORM_TRANSLATE, {ix, iy, 0.f, 0.f, 0.f, 0.f}};
+        return t;
+    }
+
+    // iDegrees follows the RotateNode convention.
+    static Transform2D Rotate(float iDegrees)
+    {
+        float a = glm::radians(iDegrees);
+        Transform2D t = {TRANSFORM_ROTATE, {std::cos(a), std::sin(a), 0.f, 0.f, 0.f, 0.f}};
+        return t;
+    }
+
+    static Transform2D Scale(float ix, float iy)
+    {
+        Transform2D t = {TRANSFORM_SCALE, {ix, iy, 0.f, 0.f, 0.f, 0.f}};
+        return t;
+    }
+
+    static Transform2D Affine(const Affine2x3& iAffine)
+    {
+        const float* m = iAffine.m;
+        Transform2D t = {TRANSFORM_AFFINE, {m[0], m[1], m[2], m[3], m[4], m[5]}};
+        return t;
+    }
+
+    static Transform2D Identity()
+    {
+        return Translate(0.f, 0.f);
+    }
+
+    // True for 0 translations, 0 degree rotations, unit scales and the identity affine.
+    bool IsIdentity() const
+    {
+        switch (kind)
+        {
+            case TRANSFORM_TRANSLATE:
+                return data[0] == 0.f && data[1] == 0.f;
+            case TRANSFORM_ROTATE:
+                return data[0] == 1.f && data[1] == 0.f;
+            case TRANSFORM_SCALE:
+                return data[0] == 1.f && data[1] == 1.f;
+        }
+        return data[0] == 1.f && data[1] == 0.f && data[2] == 0.f &&
+               data[3] == 1.f && data[4] == 0.f && data[5] == 0.f;
+    }
+
+    glm::mat3 ToMat3() const
+    {
+        return ToAffine().ToMat3();
+    }
+
+    // The same transformation in the uniform 2x3 layout.
+    Affine2x3 ToAffine() const
+    {
+        switch (kind)
+        {
+            case TRANSFORM_TRANSLATE:
+            {
+                Affine2x3 a = {{1.f, 0.f, 0.f, 1.f, data[0], data[1]}};
+                return a;
+            }
+            case TRANSFORM_ROTATE:
+            {
+                Affine2x3 a = {{data[0], data[1], -data[1], data[0], 0.f, 0.f}};
+                return a;
+            }
+            case TRANSFORM_SCALE:
+            {
+                Affine2x3 a = {{data[0], 0.f, 0.f, data[1], 0.f, 0.f}};
+                return a;
+            }
+        }
+        Affine2x3 a = {{data[0], data[1], data[2], data[3], data[4], data[5]}};
+        return a;
+    }
+};
+
+// Compose kernels: parent * local for one kind of local transformation.
+// Each one only touches what its kind can change; none of them builds a
+// full local matrix or does a general multiply.
+template<unsigned char Kind>
+inline void ComposeKernel(const Affine2x3& iParent, const float* iData, Affine2x3& oResult);
+
+template<>
+inline void ComposeKernel<TRANSFORM_TRANSLATE>(const Affine2x3& iParent, const float* iData, Affine2x3& oResult)
+{
+    // Only the translation column moves.
+    const float* p = iParent.m;
+    oResult.m[0] = p[0];
+    oResult.m[1] = p[1];
+    oResult.m[2] = p[2];
+    oResult.m[3] = p[3];
+    oResult.m[4] = p[0] * iData[0] + p[2] * iData[1] + p[4];
+    oResult.m[5] = p[1] * iData[0] + p[3] * iData[1] + p[5];
+}
+
+template<>
+inline void ComposeKernel<TRANSFORM_ROTATE>(const Affine2x3& iParent, const float* iData, Affine2x3& oResult)
+{
+    // A 2x2 multiply of the first two columns.
+    const float* p = iParent.m;
+    float c = iData[0];
+    float s = iData[1];
+    oResult.m[0] = p[0] * c + p[2] * s;
+    oResult.m[1] = p[1] * c + p[3] * s;
+    oResult.m[2] = p[2] * c - p[0] * s;
+    oResult.m[3] = p[3] * c - p[1] * s;
+    oResult.m[4] = p[4];
+    oResult.m[5] = p[5];
+}
+
+template<>
+inline void ComposeKernel<TRANSFORM_SCALE>(const Affine2x3& iParent, const float* iData, Affine2x3& oResult)
+{
+    const float* p = iParent.m;
+    oResult.m[0] = p[0] * iData[0];
+    oResult.m[1] = p[1] * iData[0];
+    oResult.m[2] = p[2] * iData[1];
+    oResult.m[3] = p[3] * iData[1];
+    oResult.m[4] = p[4];
+    oResult.m[5] = p[5];
+}
+
+template<>
+inline void ComposeKernel<TRANSFORM_AFFINE>(const Affine2x3& iParent, const float* iData, Affine2x3& oResult)
+{
+    const float* p = iParent.m;
+    oResult.m[0] = p[0] * iData[0] + p[2] * iData[1];
+    oResult.m[1] = p[1] * iData[0] + p[3] * iData[1];
+    oResult.m[2] = p[0] * iData[2] + p[2] * iData[3];
+    oResult.m[3] = p[1] * iData[2] + p[3] * iData[3];
+    oResult.m[4] = p[0] * iData[4] + p[2] * iData[5] + p[4];
+    oResult.m[5] = p[1] * iData[4] + p[3] * iData[5] + p[5];
+}
+
+// Dispatch on the tag to the matching kernel. oResult must not alias iParent.
+inline void ComposeTransform(const Affine2x3& iParent, const Transform2D& iLocal, Affine2x3& oResult)
+{
+    switch (iLocal.kind)
+    {
+        case TRANSFORM_TRANSLATE:
+            ComposeKernel<TRANSFORM_TRANSLATE>(iParent, iLocal.data, oResult);
+            break;
+        case TRANSFORM_ROTATE:
+            ComposeKernel<TRANSFORM_ROTATE>(iParent, iLocal.data, oResult);
+            break;
+        case TRANSFORM_SCALE:
+            ComposeKernel<TRANSFORM_SCALE>(iParent, iLocal.data, oResult);
+            break;
+        default:
+            ComposeKernel<TRANSFORM_AFFINE>(iParent, iLocal.data, oResult);
+            break;
+    }
+}
@@ -0,0 +1,563 @@
+#include "transformhierarchy.h"
+#include <algorithm>
+#include <utility>
+
+TransformHierarchy::TransformHierarchy()
+    : batchKernel(GetAffineBatchKernel(GetBestAffineKernel())),
+      epoch(0), firstDirty(-1), grainSize(0), boundsPending(false), compiled(false)
+{}
+
+TransformHierarchy::~TransformHierarchy()
+{
+    Invalidate();
+}
+
+void TransformHierarchy::Compile(Node& iRoot, bool iFuseChains)
+{
+    Invalidate();
+
+    // Pass 1: list the source tree in pre-order. This walks the intrusive
+    // child/sibling links, so deep chains do not recurse.
+    std::vector<int> sourceParent;
+    std::vector<int> path;
+    Node* current = &iRoot;
+    while (current != nullptr)
+    {
+        sourceParent.push_back(path.empty() ? -1 : path.back());
+        sourceNodes.push_back(current);
+
+        if (current->GetFirstChild() != nullptr)
+        {
+            path.push_back(static_cast<int>(sourceNodes.size()) - 1);
+            current = current->GetFirstChild();
+            continue;
+        }
+        while (current != &iRoot && current->GetNextSibling() == nullptr)
+        {
+            current = current->GetParent();
+            path.pop_back();
+        }
+        current = current != &iRoot ? current->GetNextSibling() : nullptr;
+    }
+
+    // Pass 2, bottom-up: subtree sizes, whether a subtree holds any geometry
+    // and how many children lead to geometry.
+    int sourceCount = static_cast<int>(sourceNodes.size());
+    std::vector<int> sourceSubtree(sourceCount, 1);
+    std::vector<unsigned char> subtreeHasGeo(sourceCount, 0);
+    std::vector<int> geoChildren(sourceCount, 0);
+    for (int i = sourceCount - 1; i >= 0; i--)
+    {
+        if (sourceNodes[i]->GetGeoId() != GEO_NONE)
+        {
+            subtreeHasGeo[i] = 1;
+        }
+        int parent = sourceParent[i];
+        if (parent >= 0)
+        {
+            sourceSubtree[parent] += sourceSubtree[i];
+            subtreeHasGeo[parent] |= subtreeHasGeo[i];
+            geoChildren[parent] += subtreeHasGeo[i];
+        }
+    }
+
+    // Pass 3, top-down: decide for every source node whether it gets an entry,
+    // is folded into the entry of its only relevant descendant, or is dropped.
+    const int FOLDED = -2;
+    const int DROPPED = -1;
+    std::vector<int> entryOf(sourceCount, DROPPED);
+    std::vector<int> runLength(sourceCount, 0);   // Folded nodes: length of the run so far.
+    std::vector<int> runParent(sourceCount, -1);  // Folded nodes: entry above the run.
+    std::vector<int> sourceDepth(sourceCount, 0);
+    std::vector<int> entryDepth;
+    std::vector<int> openEntries; // Source indices whose subtree has not been closed yet.
+    for (int i = 0; i < sourceCount; i++)
+    {
+        Node* node = sourceNodes[i];
+        int parent = sourceParent[i];
+        sourceDepth[i] = parent >= 0 ? sourceDepth[parent] + 1 : 0;
+        stats.sourceDepth = std::max(stats.sourceDepth, sourceDepth[i]);
+
+        // Emit entries whose subtree ended before i: this gives the post-order draw list.
+        while (!openEntries.empty() && openEntries.back() + sourceSubtree[openEntries.back()] <= i)
+        {
+            int closed = entryOf[openEntries.back()];
+            if (geoId[closed] != GEO_NONE)
+            {
+                drawOrder.push_back(closed);
+            }
+            openEntries.pop_back();
+        }
+
+        bool parentDropped = parent >= 0 && entryOf[parent] == DROPPED;
+        if (parentDropped || (iFuseChains && parent >= 0 && !subtreeHasGeo[i]))
+        {
+            node->BindToHierarchy(this, DROPPED);
+            continue;
+        }
+
+        bool parentFolded = parent >= 0 && entryOf[parent] == FOLDED;
+        int aboveEntry = parent < 0 ? -1 : (parentFolded ? runParent[parent] : entryOf[parent]);
+        int length = (parentFolded ? runLength[parent] : 0) + 1;
+
+        bool keep = !iFuseChains || parent < 0 || node->GetGeoId() != GEO_NONE || geoChildren[i] != 1;
+        if (!keep)
+        {
+            entryOf[i] = FOLDED;
+            runLength[i] = length;
+            runParent[i] = aboveEntry;
+            continue;
+        }
+
+        int entry = Size();
+        entryOf[i] = entry;
+        parentIndex.push_back(aboveEntry);
+        geoId.push_back(node->GetGeoId());
+        color.push_back(node->GetColor());
+        nodePtr.push_back(node);
+        chainLength.push_back(length);
+        localTransform.push_back(length > 1 ? FoldChain(node, length) : node->GetLocalTransformation());
+        entryDepth.push_back(aboveEntry >= 0 ? entryDepth[aboveEntry] + 1 : 0);
+        stats.entryDepth = std::max(stats.entryDepth, entryDepth.back());
+
+        // Every node of the run writes its edits into this entry.
+        Node* runNode = node;
+        for (int k = 0; k < length; k++)
+        {
+            runNode->BindToHierarchy(this, entry);
+            runNode = runNode->GetParent();
+        }
+        openEntries.push_back(i);
+    }
+    while (!openEntries.empty())
+    {
+        int closed = entryOf[openEntries.back()];
+        if (geoId[closed] != GEO_NONE)
+        {
+            drawOrder.push_back(closed);
+        }
+        openEntries.pop_back();
+    }
+
+    int n = Size();
+    subtreeSize.assign(n, 1);
+    for (int i = n - 1; i > 0; i--)
+    {
+        subtreeSize[parentIndex[i]] += subtreeSize[i];
+    }
+    BuildLevels();
+    worldMat.resize(n);
+    localDirty.assign(n, 1);
+    changedEpoch.assign(n, 0);
+    geoBounds.assign(n, Aabb2::Empty());
+    subtreeBounds.assign(n, Aabb2::Empty());
+    boundsDirty.assign(n, 1);
+    boundsPending = n > 0;
+    epoch = 0;
+    firstDirty = n > 0 ? 0 : -1;
+    stats.sourceNodes = sourceCount;
+    stats.entries = n;
+    compiled = true;
+}
+
+Transform2D TransformHierarchy::FoldChain(Node* iNodePtr, int iChainLength)
+{
+    foldScratch.clear();
+    Node* node = iNodePtr;
+    for (int k = 0; k < iChainLength; k++)
+    {
+        if (!node->GetLocalTransformation().IsIdentity())
+        {
+            foldScratch.push_back(&node->GetLocalTransformation());
+        }
+        node = node->GetParent();
+    }
+
+    if (foldScratch.empty())
+    {
+        return Transform2D::Identity();
+    }
+    if (foldScratch.size() == 1)
+    {
+        // A single non-identity node keeps its own, cheaper, kernel.
+        return *foldScratch[0];
+    }
+
+    // foldScratch runs bottom-up, so compose from its end.
+    Affine2x3 folded = foldScratch.back()->ToAffine();
+    Affine2x3 next;
+    for (int k = static_cast<int>(foldScratch.size()) - 2; k >= 0; k--)
+    {
+        ComposeTransform(folded, *foldScratch[k], next);
+        folded = next;
+    }
+    return Transform2D::Affine(folded);
+}
+
+void TransformHierarchy::Invalidate()
+{
+    for (std::vector<Node*>::iterator p = sourceNodes.begin(); p != sourceNodes.end(); p++)
+    {
+        (*p)->BindToHierarchy(nullptr, -1);
+    }
+    sourceNodes.clear();
+    localTransform.clear();
+    parentIndex.clear();
+    worldMat.clear();
+    geoId.clear();
+    color.clear();
+    nodePtr.clear();
+    chainLength.clear();
+    subtreeSize.clear();
+    levelOrder.clear();
+    levelSlot.clear();
+    levelStart.clear();
+    levelParent.clear();
+    for (int c = 0; c < 6; c++)
+    {
+        levelLocal[c].clear();
+        levelWorld[c].clear();
+    }
+    localDirty.clear();
+    changedEpoch.clear();
+    geoBounds.clear();
+    subtreeBounds.clear();
+    boundsDirty.clear();
+    movedShapes.clear();
+    boundsPending = false;
+    drawOrder.clear();
+    stats = HierarchyCompileStats();
+    firstDirty = -1;
+    compiled = false;
+}
+
+bool TransformHierarchy::IsCompiled() const
+{
+    return compiled;
+}
+
+void TransformHierarchy::Propagate()
+{
+    if (firstDirty < 0)
+    {
+        return;
+    }
+
+    // Also when the root is dirty: PropagateBatch() has to gather and scatter
+    // every matrix between pre-order and level order, which costs more than
+    // its kernels save (scenebench propagate-full against propagate-batch).
+    epoch++;
+    int n = Size();
+    for (int i = firstDirty; i < n; i++)
+    {
+        UpdateEntry(i);
+    }
+    firstDirty = -1;
+    boundsPending = true;
+}
+
+void TransformHierarchy::PropagateBatch()
+{
+    int n = Size();
+    if (n == 0)
+    {
+        return;
+    }
+
+    AffineArrays world;
+    AffineArrays local;
+    for (int c = 0; c < 6; c++)
+    {
+        world.m[c] = levelWorld[c].data();
+        local.m[c] = levelLocal[c].data();
+        world.m[c][0] = local.m[c][0];
+    }
+    // Each level only reads the one above it, so a level is a single batch.
+    int levels = static_cast<int>(levelStart.size()) - 1;
+    for (int d = 1; d < levels; d++)
+    {
+        batchKernel(world, local, levelParent.data(), levelStart[d], levelStart[d + 1]);
+    }
+
+    for (int k = 0; k < n; k++)
+    {
+        float* m = worldMat[levelOrder[k]].m;
+        for (int c = 0; c < 6; c++)
+        {
+            m[c] = world.m[c][k];
+        }
+    }
+    std::fill(localDirty.begin(), localDirty.end(), 0);
+    std::fill(boundsDirty.begin(), boundsDirty.end(), 1);
+    firstDirty = -1;
+    boundsPending = true;
+}
+
+void TransformHierarchy::SetBatchKernel(int iKernel)
+{
+    batchKernel = GetAffineBatchKernel(iKernel);
+    if (batchKernel == nullptr)
+    {
+        batchKernel = GetAffineBatchKernel(AFFINE_KERNEL_SCALAR);
+    }
+}
+
+void TransformHierarchy::BuildLevels()
+{
+    int n = Size();
+    std::vector<int> depth(n, 0);
+    int levels = n > 0 ? 1 : 0;
+    for (int i = 1; i < n; i++)
+    {
+        depth[i] = depth[parentIndex[i]] + 1;
+        levels = std::max(levels, depth[i] + 1);
+    }
+
+    // Counting sort by depth; pre-order is kept inside a level.
+    levelStart.assign(levels + 1, 0);
+    for (int i = 0; i < n; i++)
+    {
+        levelStart[depth[i] + 1]++;
+    }
+    for (int d = 0; d < levels; d++)
+    {
+        levelStart[d + 1] += levelStart[d];
+    }
+    std::vector<int> next(levelStart.begin(), levelStart.end() - (levels > 0 ? 1 : 0));
+    levelOrder.resize(n);
+    levelSlot.resize(n);
+    for (int i = 0; i < n; i++)
+    {
+        int k = next[depth[i]]++;
+        levelOrder[k] = i;
+        levelSlot[i] = k;
+    }
+
+    levelParent.resize(n);
+    for (int c = 0; c < 6; c++)
+    {
+        levelLocal[c].resize(n);
+        levelWorld[c].resize(n);
+    }
+    for (int k = 0; k < n; k++)
+    {
+        int i = levelOrder[k];
+        levelParent[k] = parentIndex[i] >= 0 ? levelSlot[parentIndex[i]] : 0;
+        Affine2x3 a = localTransform[i].ToAffine();
+        for (int c = 0; c < 6; c++)
+        {
+            levelLocal[c][k] = a.m[c];
+        }
+    }
+}
+
+void TransformHierarchy::PropagateParallel(TaskPool& ioPool, int iGrainSize)
+{
+    if (firstDirty < 0)
+    {
+        return;
+    }
+    if (ioPool.GetThreadCount() <= 1 || Size() <= iGrainSize)
+    {
+        Propagate();
+        return;
+    }
+
+    // Entries before firstDirty are clean but their subtrees may not be, so
+    // the tasks start at the root; the clean ones cost a compare each.
+    epoch++;
+    grainSize = iGrainSize > 1 ? iGrainSize : 1;
+    ioPool.Run(&TransformHierarchy::PropagateRange, this, 0, Size());
+    firstDirty = -1;
+    boundsPending = true;
+}
+
+void TransformHierarchy::PropagateRange(TaskPool& ioPool, void* iContext, int iBegin, int iEnd)
+{
+    TransformHierarchy* h = static_cast<TransformHierarchy*>(iContext);
+    // Ranges this task still owes; a loop instead of recursion, so deep trees
+    // cannot overflow the worker's stack.
+    std::vector<std::pair<int, int>> ranges(1, std::make_pair(iBegin, iEnd));
+    while (!ranges.empty())
+    {
+        int i = ranges.back().first;
+        int end = ranges.back().second;
+        ranges.pop_back();
+        while (i < end)
+        {
+            int size = h->subtreeSize[i];
+            if (size <= h->grainSize)
+            {
+                for (int last = i + size; i < last; i++)
+                {
+                    h->UpdateEntry(i);
+                }
+                continue;
+            }
+
+            // A big subtree: do its root, then hand out its children in runs of
+            // about grainSize entries. The last run stays with this task, so a
+            // long chain never turns into a task per entry.
+            h->UpdateEntry(i);
+            int childEnd = i + size;
+            int runBegin = i + 1;
+            for (int c = i + 1; c < childEnd; )
+            {
+                c += h->subtreeSize[c];
+                if (c - runBegin >= h->grainSize && c < childEnd)
+                {
+                    ioPool.Spawn(&TransformHierarchy::PropagateRange, h, runBegin, c);
+                    runBegin = c;
+                }
+            }
+            if (childEnd < end)
+            {
+                ranges.push_back(std::make_pair(childEnd, end));
+            }
+            i = runBegin;
+            end = childEnd;
+        }
+    }
+}
+
+void TransformHierarchy::UpdateEntry(int i)
+{
+    int parent = parentIndex[i];
+    bool parentChanged = parent >= 0 && changedEpoch[parent] == epoch;
+    if (!localDirty[i] && !parentChanged)
+    {
+        return;
+    }
+
+    // The kernel is picked from the entry's tag; no local mat3 is ever built.
+    static const Affine2x3 identity = Affine2x3::Identity();
+    ComposeTransform(parent >= 0 ? worldMat[parent] : identity, localTransform[i], worldMat[i]);
+    localDirty[i] = 0;
+    changedEpoch[i] = epoch;
+    boundsDirty[i] = 1;
+}
+
+void TransformHierarchy::UpdateBounds()
+{
+    movedShapes.clear();
+    if (!boundsPending)
+    {
+        return;
+    }
+    // Children come after their parent, so walking backwards finishes every
+    // child before its parent needs it. A dirty entry dirties its parent, so
+    // the changes climb to the root and everything else is skipped. Entries
+    // that are only dirty because of a child (2) keep their geometry bounds.
+    for (int i = Size() - 1; i >= 0; i--)
+    {
+        if (!boundsDirty[i])
+        {
+            continue;
+        }
+        if (boundsDirty[i] == 1)
+        {
+            geoBounds[i] = TransformBounds(GetGeometryBounds(geoId[i]), worldMat[i]);
+            if (geoId[i] != GEO_NONE)
+            {
+                movedShapes.push_back(i);
+            }
+        }
+        Aabb2 bounds = geoBounds[i];
+        for (int c = i + 1, end = i + subtreeSize[i]; c < end; c += subtreeSize[c])
+        {
+            bounds.Include(subtreeBounds[c]);
+        }
+        subtreeBounds[i] = bounds;
+        boundsDirty[i] = 0;
+        if (parentIndex[i] >= 0 && !boundsDirty[parentIndex[i]])
+        {
+            boundsDirty[parentIndex[i]] = 2;
+        }
+    }
+    boundsPending = false;
+}
+
+int TransformHierarchy::CullDrawOrder(const Aabb2& iView, std::vector<int>& oDrawOrder)
+{
+    // A pre-order walk that jumps over subtrees outside iView. Like in
+    // Compile(), an entry is emitted once its subtree is done, which keeps
+    // the post-order of GetDrawOrder().
+    oDrawOrder.clear();
+    cullStack.clear();
+    int skipped = 0;
+    int n = Size();
+    int i = 0;
+    for (;;)
+    {
+        while (!cullStack.empty() && cullStack.back() + subtreeSize[cullStack.back()] <= i)
+        {
+            int closed = cullStack.back();
+            if (geoId[closed] != GEO_NONE && geoBounds[closed].Intersects(iView))
+            {
+                oDrawOrder.push_back(closed);
+            }
+            cullStack.pop_back();
+        }
+        if (i >= n)
+        {
+            break;
+        }
+        if (!subtreeBounds[i].Intersects(iView))
+        {
+            skipped += !subtreeBounds[i].IsEmpty();
+            i += subtreeSize[i];
+            continue;
+        }
+        cullStack.push_back(i);
+        i++;
+    }
+    return skipped;
+}
+
+void TransformHierarchy::SetLocalTransformation(int i, const Transform2D& iLocal)
+{
+    if (i < 0)
+    {
+        // The node does not contribute to anything that is drawn.
+        return;
+    }
+    localTransform[i] = chainLength[i] > 1 ? FoldChain(nodePtr[i], chainLength[i]) : iLocal;
+    Affine2x3 a = localTransform[i].ToAffine();
+    for (int c = 0; c < 6; c++)
+    {
+        levelLocal[c][levelSlot[i]] = a.m[c];
+    }
+    localDirty[i] = 1;
+    if (firstDirty < 0 || i < firstDirty)
+    {
+        firstDirty = i;
+    }
+}
+
+void TransformHierarchy::SetColor(int i, const glm::vec3& iColor)
+{
+    if (i >= 0)
+    {
+        color[i] = iColor;
+    }
+}
+
+int TransformHierarchy::Size() const
+{
+    return static_cast<int>(localTransform.size());
+}
+
+const std::vector<int>& TransformHierarchy::GetDrawOrder() const
+{
+    return drawOrder;
+}
+
+const std::vector<int>& TransformHierarchy::GetMovedShapes() const
+{
+    return movedShapes;
+}
+
+const HierarchyCompileStats& TransformHierarchy::GetCompileStats() const
+{
+    return stats;
+}
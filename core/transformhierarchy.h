@@ -0,0 +1,135 @@
+#pragma once
+#include "aabb2.h"
+#include "affinebatch.h"
+#include "coremath.h"
+#include "node.h"
+#include "taskpool.h"
+#include <vector>
+
+// Sizes of the source tree and of the compiled evaluation graph.
+struct HierarchyCompileStats
+{
+    int sourceNodes = 0;
+    int entries = 0;
+    int sourceDepth = 0;
+    int entryDepth = 0;
+};
+
+// A flattened, structure-of-arrays copy of the Node tree.
+// Entries are stored in depth-first (pre-order) order, so every parent comes
+// before its children and world transforms can be propagated in one linear
+// pass over the arrays. The Node tree stays the editing front-end: its setters
+// write the new parameters into this structure through SetLocalTransformation().
+//
+// When compiled with iFuseChains the arrays form a smaller render-side graph:
+//   * subtrees without any geometry are dropped,
+//   * runs of non-branching nodes without geometry are folded into the entry
+//     of the node that ends the run, as one precomputed transformation,
+//   * identity nodes (0 translations, 0 degree rotations, unit scales) vanish
+//     from the folded transformations.
+// A folded run is only composed again when one of its nodes is edited.
+//
+// The hierarchy also keeps a level-ordered structure-of-arrays copy of the
+// local transformations, which the SIMD batch kernels from affinebatch.h
+// compose one tree level at a time in PropagateBatch().
+class TransformHierarchy
+{
+public:
+    TransformHierarchy();
+    // Unbinds the nodes, which may outlive the hierarchy.
+    ~TransformHierarchy();
+    TransformHierarchy(const TransformHierarchy&) = delete;
+    TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+
+    // Rebuild the arrays from the tree rooted at iRoot and bind every node to its entry.
+    void Compile(Node& iRoot, bool iFuseChains = false);
+    // Drop the compiled arrays, e.g. after the structure of the tree has changed.
+    void Invalidate();
+    bool IsCompiled() const;
+
+    // Recompute the world matrix of every entry whose local transformation
+    // (or one of whose ancestors' transformations) changed since the last call,
+    // in one linear pass over the entries from the first dirty one.
+    void Propagate();
+    // Recompute every entry, level by level, with the batch kernel. The results
+    // are scattered back into pre-order, so this does not beat a full
+    // Propagate(); it is kept for the kernels' benchmark in scenebench.
+    void PropagateBatch();
+    // Pick the batch kernel, one of AFFINE_KERNEL_*; unsupported ones fall back to scalar.
+    void SetBatchKernel(int iKernel);
+    // Same result as Propagate(), computed on ioPool. Because entries are stored in
+    // pre-order every subtree, and every run of sibling subtrees, is a contiguous
+    // range. The children of a subtree larger than iGrainSize are cut into runs of
+    // about iGrainSize entries, and each run becomes a task.
+    void PropagateParallel(TaskPool& ioPool, int iGrainSize);
+
+    // Recompute the bounds of the entries whose world matrix changed in the
+    // propagations since the last call, and of their ancestors. Costs nothing
+    // when nothing was propagated.
+    void UpdateBounds();
+    // The entries with geometry whose geoBounds the last UpdateBounds() recomputed,
+    // children before their parent. Every one of them after a Compile().
+    const std::vector<int>& GetMovedShapes() const;
+    // GetDrawOrder() without the entries whose geometry lies outside iView.
+    // Subtrees whose bounds miss iView are skipped whole; returns how many of
+    // those held any geometry.
+    // The bounds have to be up to date (UpdateBounds()).
+    int CullDrawOrder(const Aabb2& iView, std::vector<int>& oDrawOrder);
+
+    // Called by the node bound to entry i; i is -1 for nodes that were dropped.
+    void SetLocalTransformation(int i, const Transform2D& iLocal);
+    void SetColor(int i, const glm::vec3& iColor);
+
+    int Size() const;
+    // Indices of the entries that carry geometry, in the order they have to be
+    // drawn (children before their parent, like the recursive traversal).
+    const std::vector<int>& GetDrawOrder() const;
+    const HierarchyCompileStats& GetCompileStats() const;
+
+    std::vector<Transform2D> localTransform; // Compact T/R/S parameters of every entry.
+    std::vector<int> parentIndex;    // -1 for the root
+    std::vector<Affine2x3> worldMat; // 24 bytes per entry, laid out for glUniformMatrix3x2fv.
+    std::vector<GeometryId> geoId;
+    std::vector<glm::vec3> color;
+    std::vector<Node*> nodePtr;      // The node that ends the entry's run.
+    std::vector<int> chainLength;    // How many source nodes were folded into the entry.
+    std::vector<int> subtreeSize;    // Entries in the subtree of the entry, itself included.
+    std::vector<Aabb2> geoBounds;    // World-space bounds of the entry's geometry; empty without one.
+    std::vector<Aabb2> subtreeBounds; // geoBounds of the entry and its whole subtree together.
+
+private:
+    // Compose the local transformations of the chainLength nodes ending at iNodePtr.
+    Transform2D FoldChain(Node* iNodePtr, int iChainLength);
+    // Recompute the world matrix of entry i if it or its parent changed in this pass.
+    void UpdateEntry(int i);
+    // Rebuild the level-ordered arrays used by PropagateBatch().
+    void BuildLevels();
+    // Task body of PropagateParallel(): update [iBegin, iEnd), a run of whole
+    // subtrees whose parents are already up to date.
+    static void PropagateRange(TaskPool& ioPool, void* iContext, int iBegin, int iEnd);
+
+    std::vector<Node*> sourceNodes; // Every node bound to this hierarchy, in pre-order.
+    std::vector<unsigned char> localDirty;
+    std::vector<unsigned int> changedEpoch; // An entry changed in the current pass iff its value equals epoch.
+    std::vector<unsigned char> boundsDirty; // 1 if the world matrix changed, 2 if only a child's bounds did.
+    std::vector<int> movedShapes;
+    std::vector<int> cullStack;
+    std::vector<int> drawOrder;
+    std::vector<const Transform2D*> foldScratch;
+
+    // Level-ordered copy for PropagateBatch(): slot k holds entry levelOrder[k],
+    // the slots of one depth are contiguous and start at levelStart[depth].
+    std::vector<int> levelOrder;
+    std::vector<int> levelSlot;     // Inverse of levelOrder.
+    std::vector<int> levelStart;    // One more element than there are levels.
+    std::vector<int> levelParent;   // Slot of the parent, 0 for the root.
+    std::vector<float> levelLocal[6];
+    std::vector<float> levelWorld[6];
+    AffineBatchKernel batchKernel;
+    HierarchyCompileStats stats;
+    unsigned int epoch;
+    int firstDirty; // Smallest dirty index, or -1 when nothing has to be propagated.
+    int grainSize;  // Of the PropagateParallel() in progress.
+    bool boundsPending; // Some entry's world matrix changed since the last UpdateBounds().
+    bool compiled;
+};
@@ -1,8 +1,14 @@
 #version 150
 // ^ Change this to version 130 if you have compatibility issues
 
-uniform mat3 u_Model;
-uniform mat3 u_View;
+// 2D affine transforms: three columns of two rows, the bottom row (0, 0, 1) is implied.
+uniform mat3x2 u_Model;
+uniform mat3x2 u_View;
+// Tints the per-vertex color. Shapes have no color buffer; for them vs_Col is
+// the constant (1, 1, 1), so u_Color is the color of the node being drawn.
+uniform vec3 u_Color;
+// Only used while the depth test is on; see SceneRenderer::SubmitQueue.
+uniform float u_Depth;
 
 in vec3 vs_Pos;
 in vec3 vs_Col;
@@ -11,10 +17,13 @@ out vec3 fs_Col;
 
 void main()
 {
-    fs_Col = vs_Col;
+    fs_Col = u_Color * vs_Col;
 
     //built-in things to pass down the pipeline
-    vec3 finalPos = u_View * u_Model * vs_Pos;
-    gl_Position = vec4(finalPos.xy, finalPos.z - 0.001, 1);
+    // vs_Pos.z is the homogeneous weight: 1 for the shapes, 0 for the grid lines.
+    // The affine transforms keep it unchanged.
+    vec2 worldPos = u_Model * vs_Pos;
+    vec2 finalPos = u_View * vec3(worldPos, vs_Pos.z);
+    gl_Position = vec4(finalPos, u_Depth, 1);
 
 }
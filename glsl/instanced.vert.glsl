@@ -0,0 +1,27 @@
+#version 150
+// ^ Change this to version 130 if you have compatibility issues
+
+// Like flat.vert.glsl, but the model matrix and the color come per instance
+// from a texture buffer, see InstanceBuffer.
+uniform mat3x2 u_View;
+uniform samplerBuffer u_Instances;
+uniform int u_InstanceBase; // The record of the first instance in this draw call
+
+in vec3 vs_Pos;
+
+out vec3 fs_Col;
+
+void main()
+{
+    int record = (u_InstanceBase + gl_InstanceID) * 3;
+    vec4 columns = texelFetch(u_Instances, record);
+    vec4 translation = texelFetch(u_Instances, record + 1);
+    fs_Col = texelFetch(u_Instances, record + 2).rgb;
+
+    mat3x2 model = mat3x2(columns.xy, columns.zw, translation.xy);
+    vec2 worldPos = model * vs_Pos;
+    vec2 finalPos = u_View * vec3(worldPos, vs_Pos.z);
+    // Instances of different shapes are drawn in separate calls; their depth
+    // puts them back into the scene's draw order.
+    gl_Position = vec4(finalPos, translation.z, 1);
+}
@@ -14,6 +14,7 @@ CONFIG += debug
 
 INCLUDEPATH += include
 
+include(core/core.pri)
 include(src/src.pri)
 
 FORMS += forms/mainwindow.ui
@@ -1,8 +1,8 @@
 #include "drawable.h"
 #include <la.h>
 
-Drawable::Drawable(OpenGLContext* context)
-    : m_bufIdx(), m_bufPos(), m_bufCol(),
+Drawable::Drawable(GLFunctions* context)
+    : m_bufIdx(), m_bufPos(), m_bufCol(), m_vao(),
       m_idxBound(false), m_posBound(false), m_colBound(false),
       mp_context(context)
 {}
@@ -17,6 +17,8 @@ void Drawable::destroy()
     mp_context->glDeleteBuffers(1, &m_bufIdx);
     mp_context->glDeleteBuffers(1, &m_bufPos);
     mp_context->glDeleteBuffers(1, &m_bufCol);
+    mp_context->glDeleteVertexArrays(1, &m_vao);
+    m_vao = 0;
 }
 
 GLenum Drawable::drawMode()
@@ -82,3 +84,34 @@ bool Drawable::bindCol()
     }
     return m_colBound;
 }
+
+void Drawable::createVao()
+{
+    mp_context->glGenVertexArrays(1, &m_vao);
+    mp_context->glBindVertexArray(m_vao);
+
+    if (bindPos())
+    {
+        mp_context->glEnableVertexAttribArray(ATTR_POS);
+        mp_context->glVertexAttribPointer(ATTR_POS, 3, GL_FLOAT, false, 0, NULL);
+    }
+    if (bindCol())
+    {
+        mp_context->glEnableVertexAttribArray(ATTR_COL);
+        mp_context->glVertexAttribPointer(ATTR_COL, 3, GL_FLOAT, false, 0, NULL);
+    }
+    // The element array binding is part of the VAO as well.
+    bindIdx();
+
+    mp_context->glBindVertexArray(0);
+}
+
+void Drawable::bindVao()
+{
+    mp_context->glBindVertexArray(m_vao);
+}
+
+bool Drawable::hasCol() const
+{
+    return m_colBound;
+}
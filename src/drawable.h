@@ -1,8 +1,13 @@
 #pragma once
 
-#include <openglcontext.h>
+#include <glfunctions.h>
 #include <la.h>
 
+// Attribute locations every ShaderProgram binds vs_Pos and vs_Col to before linking,
+// so that a vertex array object captured once works with all of them.
+const GLuint ATTR_POS = 0;
+const GLuint ATTR_COL = 1;
+
 //This defines a class which can be rendered by our shader program.
 //Make any geometry a subclass of ShaderProgram::Drawable in order to render it with the ShaderProgram class.
 class Drawable
@@ -13,22 +18,23 @@ protected:
     GLuint m_bufPos; // A Vertex Buffer Object that we will use to store mesh vertices (vec4s)
     GLuint m_bufCol; // Can be used to pass per-vertex color information to the shader, but is currently unused.
                    // Instead, we use a uniform vec3 in the shader to set an overall color for the geometry
+    GLuint m_vao;    // Records the buffers above and their attribute layout; see createVao()
 
     bool m_idxBound; // Set to TRUE by generateIdx(), returned by bindIdx().
     bool m_posBound;
     bool m_colBound;
 
-    OpenGLContext* mp_context; // Since Qt's OpenGL support is done through classes like QOpenGLFunctions_3_2_Core,
+    GLFunctions* mp_context; // Since Qt's OpenGL support is done through classes like QOpenGLFunctions_3_2_Core,
                           // we need to pass our OpenGL context to the Drawable in order to call GL functions
                           // from within this class.
 
 
 public:
-    Drawable(OpenGLContext* context);
+    Drawable(GLFunctions* context);
     virtual ~Drawable();
 
     virtual void create() = 0; // To be implemented by subclasses. Populates the VBOs of the Drawable.
-    void destroy(); // Frees the VBOs of the Drawable.
+    void destroy(); // Frees the VBOs and the VAO of the Drawable.
 
     // Getter functions for various GL data
     virtual GLenum drawMode();
@@ -43,6 +49,17 @@ public:
     bool bindIdx();
     bool bindPos();
     bool bindCol();
+
+    // Bind the VAO captured by createVao(): the whole vertex setup of a draw in one call.
+    void bindVao();
+    // Whether there is a color buffer; without one vs_Col reads the current attribute value.
+    bool hasCol() const;
+
+protected:
+    // Record the filled buffers in a VAO, with positions at ATTR_POS and colors at
+    // ATTR_COL. Subclasses call it at the end of create(). Leaves no VAO bound, so
+    // later buffer bindings cannot change it.
+    void createVao();
 };
 
 
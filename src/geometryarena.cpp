@@ -0,0 +1,116 @@
+#include "geometryarena.h"
+#include <algorithm>
+
+// Enough for every built-in shape many times over, so they fit without growing.
+static const GLsizeiptr INITIAL_ARENA_BYTES = 64 * 1024;
+// Meshes are appended with glBufferSubData after the storage exists, which
+// drivers flag as misuse of a GL_STATIC_DRAW buffer.
+static const GLenum ARENA_USAGE = GL_DYNAMIC_DRAW;
+
+GeometryArena::GeometryArena(GLFunctions* context)
+    : m_vertexBuffer(), m_indexBuffer(), m_vao(),
+      m_vertexCapacity(0), m_vertexUsed(0), m_indexCapacity(0), m_indexUsed(0),
+      m_meshCount(0),
+      mp_context(context)
+{}
+
+void GeometryArena::create()
+{
+    mp_context->glGenBuffers(1, &m_vertexBuffer);
+    mp_context->glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    mp_context->glBufferData(GL_ARRAY_BUFFER, INITIAL_ARENA_BYTES, nullptr, ARENA_USAGE);
+    m_vertexCapacity = INITIAL_ARENA_BYTES;
+
+    // Without a VAO bound there is no GL_ELEMENT_ARRAY_BUFFER binding in a
+    // core profile, so index data always goes through GL_COPY_WRITE_BUFFER.
+    mp_context->glGenBuffers(1, &m_indexBuffer);
+    mp_context->glBindBuffer(GL_COPY_WRITE_BUFFER, m_indexBuffer);
+    mp_context->glBufferData(GL_COPY_WRITE_BUFFER, INITIAL_ARENA_BYTES, nullptr, ARENA_USAGE);
+    m_indexCapacity = INITIAL_ARENA_BYTES;
+
+    mp_context->glGenVertexArrays(1, &m_vao);
+    captureVao();
+}
+
+void GeometryArena::destroy()
+{
+    mp_context->glDeleteBuffers(1, &m_vertexBuffer);
+    mp_context->glDeleteBuffers(1, &m_indexBuffer);
+    mp_context->glDeleteVertexArrays(1, &m_vao);
+    m_vertexBuffer = 0;
+    m_indexBuffer = 0;
+    m_vao = 0;
+    m_vertexCapacity = m_vertexUsed = 0;
+    m_indexCapacity = m_indexUsed = 0;
+    m_meshCount = 0;
+}
+
+void GeometryArena::reserve(GLuint& ioBuffer, GLsizeiptr& ioCapacity, GLsizeiptr iUsed, GLsizeiptr iNeeded)
+{
+    if (iUsed + iNeeded <= ioCapacity)
+    {
+        return;
+    }
+
+    GLsizeiptr capacity = std::max(ioCapacity * 2, iUsed + iNeeded);
+    GLuint buffer = 0;
+    mp_context->glGenBuffers(1, &buffer);
+    mp_context->glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    mp_context->glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, ARENA_USAGE);
+    mp_context->glBindBuffer(GL_COPY_READ_BUFFER, ioBuffer);
+    mp_context->glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, iUsed);
+    mp_context->glDeleteBuffers(1, &ioBuffer);
+
+    ioBuffer = buffer;
+    ioCapacity = capacity;
+}
+
+ArenaMesh GeometryArena::add(const std::vector<glm::vec3>& positions, const std::vector<GLuint>& indices, GLenum mode)
+{
+    GLsizeiptr vertexBytes = positions.size() * sizeof(glm::vec3);
+    GLsizeiptr indexBytes = indices.size() * sizeof(GLuint);
+    GLuint vertexBuffer = m_vertexBuffer;
+    GLuint indexBuffer = m_indexBuffer;
+    reserve(m_vertexBuffer, m_vertexCapacity, m_vertexUsed, vertexBytes);
+    reserve(m_indexBuffer, m_indexCapacity, m_indexUsed, indexBytes);
+    if (m_vertexBuffer != vertexBuffer || m_indexBuffer != indexBuffer)
+    {
+        captureVao();
+    }
+
+    ArenaMesh mesh;
+    mesh.baseVertex = GLint(m_vertexUsed / sizeof(glm::vec3));
+    mesh.indexCount = GLsizei(indices.size());
+    mesh.indexOffset = m_indexUsed;
+    mesh.mode = mode;
+
+    mp_context->glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    mp_context->glBufferSubData(GL_ARRAY_BUFFER, m_vertexUsed, vertexBytes, positions.data());
+    mp_context->glBindBuffer(GL_COPY_WRITE_BUFFER, m_indexBuffer);
+    mp_context->glBufferSubData(GL_COPY_WRITE_BUFFER, m_indexUsed, indexBytes, indices.data());
+    m_vertexUsed += vertexBytes;
+    m_indexUsed += indexBytes;
+    m_meshCount++;
+    return mesh;
+}
+
+void GeometryArena::captureVao()
+{
+    mp_context->glBindVertexArray(m_vao);
+    mp_context->glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    mp_context->glEnableVertexAttribArray(ATTR_POS);
+    mp_context->glVertexAttribPointer(ATTR_POS, 3, GL_FLOAT, false, 0, NULL);
+    mp_context->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+    // Leave no VAO bound, so later GL_ELEMENT_ARRAY_BUFFER bindings cannot change this one.
+    mp_context->glBindVertexArray(0);
+}
+
+void GeometryArena::bind()
+{
+    mp_context->glBindVertexArray(m_vao);
+}
+
+int GeometryArena::meshCount() const
+{
+    return m_meshCount;
+}
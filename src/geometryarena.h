@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glfunctions.h>
+#include <la.h>
+#include "drawable.h"
+#include <vector>
+
+// Where one mesh lives inside a GeometryArena.
+struct ArenaMesh
+{
+    GLint baseVertex = 0;       // Added to every index of the mesh
+    GLsizei indexCount = 0;
+    GLsizeiptr indexOffset = 0; // In bytes, into the index buffer
+    GLenum mode = GL_TRIANGLES;
+};
+
+// One vertex buffer and one index buffer shared by every mesh. Switching
+// shapes then needs no rebinding: a draw only names its index range and its
+// base vertex (glDrawElementsBaseVertex, core since GL 3.2). Meshes are
+// appended; when a buffer is full it is doubled and the old contents are
+// copied over on the GPU. One VAO covers every mesh, since the base vertex
+// does the offsetting that separate attribute pointers would otherwise do.
+class GeometryArena
+{
+public:
+    GeometryArena(GLFunctions* context);
+
+    void create();
+    void destroy();
+
+    // Copy a mesh into the arena. The indices start at 0 for the mesh's first vertex.
+    ArenaMesh add(const std::vector<glm::vec3>& positions, const std::vector<GLuint>& indices, GLenum mode);
+
+    // Bind the arena's VAO, which holds both buffers and the position attribute at ATTR_POS.
+    void bind();
+
+    int meshCount() const;
+
+private:
+    // Make room for iNeeded more bytes in ioBuffer, which holds iUsed of ioCapacity bytes.
+    void reserve(GLuint& ioBuffer, GLsizeiptr& ioCapacity, GLsizeiptr iUsed, GLsizeiptr iNeeded);
+    // Record the current buffers in m_vao; needed again whenever reserve() replaced one.
+    void captureVao();
+
+    GLuint m_vertexBuffer;
+    GLuint m_indexBuffer;
+    GLuint m_vao;
+    GLsizeiptr m_vertexCapacity; // Bytes allocated and used in each buffer
+    GLsizeiptr m_vertexUsed;
+    GLsizeiptr m_indexCapacity;
+    GLsizeiptr m_indexUsed;
+    int m_meshCount;
+
+    GLFunctions* mp_context;
+};
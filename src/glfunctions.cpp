@@ -0,0 +1,351 @@
+#include "glfunctions.h"
+
+#include <cstring>
+#include <iostream>
+
+
+// Never returned by glGen*, so nothing compares equal to it.
+static const GLuint STATE_UNKNOWN = ~GLuint(0);
+
+GLFunctions::GLFunctions()
+    : m_validation(validationFromEnvironment()), mp_debugLogger(nullptr),
+      m_validationSite("setup"), m_frameMessages(0)
+{
+    invalidateStateCache();
+}
+
+GLFunctions::~GLFunctions()
+{
+    delete mp_debugLogger;
+}
+
+static const char* glErrorName(GLenum error)
+{
+    return error == GL_INVALID_OPERATION             ? "GL_INVALID_OPERATION" :
+           error == GL_INVALID_ENUM                  ? "GL_INVALID_ENUM" :
+           error == GL_INVALID_VALUE                 ? "GL_INVALID_VALUE" :
+           error == GL_INVALID_INDEX                 ? "GL_INVALID_INDEX" :
+           error == GL_INVALID_FRAMEBUFFER_OPERATION ? "GL_INVALID_FRAMEBUFFER_OPERATION" :
+           error == GL_OUT_OF_MEMORY                 ? "GL_OUT_OF_MEMORY" :
+           "unknown";
+}
+
+void GLFunctions::printGLErrorLog()
+{
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+        reportGLError(error, nullptr);
+    }
+}
+
+void GLFunctions::reportGLError(GLenum error, const char* site)
+{
+    std::cerr << "OpenGL error " << error << ": " << glErrorName(error);
+    if (site != nullptr) {
+        std::cerr << " in " << site;
+    }
+    std::cerr << std::endl;
+    // Throwing here allows us to use the debugger to track down the error.
+#ifndef __APPLE__
+    // Don't do this on OS X.
+    // http://lists.apple.com/archives/mac-opengl/2012/Jul/msg00038.html
+    throw;
+#endif
+}
+
+GLValidation GLFunctions::validationFromEnvironment()
+{
+    QByteArray value = qgetenv("SCENEGRAPH_GL_VALIDATION");
+    if (value.isEmpty()) {
+#ifdef QT_NO_DEBUG
+        return VALIDATION_OFF;
+#else
+        return VALIDATION_FRAME;
+#endif
+    }
+    if (std::strcmp(value.constData(), "call") == 0) {
+        return VALIDATION_CALL;
+    }
+    if (std::strcmp(value.constData(), "frame") == 0) {
+        return VALIDATION_FRAME;
+    }
+    return VALIDATION_OFF;
+}
+
+GLValidation GLFunctions::validation() const
+{
+    return m_validation;
+}
+
+void GLFunctions::setValidation(GLValidation level)
+{
+    m_validation = level;
+    if (mp_debugLogger == nullptr) {
+        return;
+    }
+    // Synchronous messages arrive inside the failing call, so the recorded site is
+    // exact; asynchronous ones cost nothing on the calling thread but may come later.
+    mp_debugLogger->stopLogging();
+    if (level != VALIDATION_OFF) {
+        mp_debugLogger->startLogging(level == VALIDATION_CALL ? QOpenGLDebugLogger::SynchronousLogging
+                                                              : QOpenGLDebugLogger::AsynchronousLogging);
+    }
+}
+
+void GLFunctions::startDebugLogging()
+{
+    // QOpenGLDebugLogger uses KHR_debug only; drivers that have nothing but
+    // ARB_debug_output are left to glGetError.
+    QOpenGLDebugLogger* logger = new QOpenGLDebugLogger();
+    if (!logger->initialize()) {
+        printf("KHR_debug is not available; GL errors are found through glGetError only\n");
+        delete logger;
+        return;
+    }
+    mp_debugLogger = logger;
+    // Notifications report things like buffer placement, nothing to act upon.
+    mp_debugLogger->disableMessages(QOpenGLDebugMessage::AnySource, QOpenGLDebugMessage::AnyType,
+                                    QOpenGLDebugMessage::NotificationSeverity);
+    QObject::connect(mp_debugLogger, &QOpenGLDebugLogger::messageLogged, mp_debugLogger,
+                     [this](const QOpenGLDebugMessage& message) { debugMessageLogged(message); });
+    setValidation(m_validation);
+}
+
+void GLFunctions::checkGL(const char* site)
+{
+    if (m_validation == VALIDATION_OFF) {
+        return;
+    }
+    m_validationSite = site;
+    if (m_validation == VALIDATION_CALL) {
+        GLenum error = glGetError();
+        if (error != GL_NO_ERROR) {
+            reportGLError(error, site);
+        }
+    }
+}
+
+void GLFunctions::finishFrameValidation()
+{
+    if (m_validation != VALIDATION_FRAME) {
+        return;
+    }
+    // One glGetError sync per frame instead of one per draw. GL keeps only
+    // one flag per kind of error, so this counts kinds rather than calls.
+    GLenum first = GL_NO_ERROR;
+    int errors = 0;
+    for (GLenum error = glGetError(); error != GL_NO_ERROR; error = glGetError()) {
+        first = first == GL_NO_ERROR ? error : first;
+        errors++;
+    }
+    if (errors > 0 || m_frameMessages > 0) {
+        std::cerr << "GL validation: " << errors << " errors";
+        if (first != GL_NO_ERROR) {
+            std::cerr << " (" << glErrorName(first) << ")";
+        }
+        std::cerr << ", " << m_frameMessages << " debug messages this frame" << std::endl;
+    }
+    m_frameMessages = 0;
+}
+
+void GLFunctions::debugMessageLogged(const QOpenGLDebugMessage& message)
+{
+    // Per frame, only the first message is printed in full; the summary counts the rest.
+    if (m_validation == VALIDATION_CALL || m_frameMessages == 0) {
+        std::cerr << "GL debug message near " << m_validationSite << ": "
+                  << message.message().toStdString() << std::endl;
+    }
+    m_frameMessages++;
+}
+
+void GLFunctions::printLinkInfoLog(int prog)
+{
+    GLint linked;
+    glGetProgramiv(prog, GL_LINK_STATUS, &linked);
+    if (linked == GL_TRUE) {
+        return;
+    }
+    std::cerr << "GLSL LINK ERROR" << std::endl;
+
+    int infoLogLen = 0;
+    int charsWritten = 0;
+    GLchar *infoLog;
+
+    glGetProgramiv(prog, GL_INFO_LOG_LENGTH, &infoLogLen);
+
+    if (infoLogLen > 0) {
+        infoLog = new GLchar[infoLogLen];
+        // error check for fail to allocate memory omitted
+        glGetProgramInfoLog(prog, infoLogLen, &charsWritten, infoLog);
+        std::cerr << "InfoLog:" << std::endl << infoLog << std::endl;
+        delete[] infoLog;
+    }
+    // Throwing here allows us to use the debugger to track down the error.
+    throw;
+}
+
+void GLFunctions::printShaderInfoLog(int shader)
+{
+    GLint compiled;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_TRUE) {
+        return;
+    }
+    std::cerr << "GLSL COMPILE ERROR" << std::endl;
+
+    int infoLogLen = 0;
+    int charsWritten = 0;
+    GLchar *infoLog;
+
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLogLen);
+
+    if (infoLogLen > 0) {
+        infoLog = new GLchar[infoLogLen];
+        // error check for fail to allocate memory omitted
+        glGetShaderInfoLog(shader, infoLogLen, &charsWritten, infoLog);
+        std::cerr << "InfoLog:" << std::endl << infoLog << std::endl;
+        delete[] infoLog;
+    }
+    // Throwing here allows us to use the debugger to track down the error.
+    throw;
+}
+
+void GLFunctions::glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+    m_uploads.allocations++;
+    m_uploads.bytes += data != nullptr ? size : 0;
+    QOpenGLFunctions_3_2_Core::glBufferData(target, size, data, usage);
+}
+
+void GLFunctions::glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+{
+    m_uploads.updates++;
+    m_uploads.bytes += size;
+    QOpenGLFunctions_3_2_Core::glBufferSubData(target, offset, size, data);
+}
+
+const BufferUploadStats& GLFunctions::bufferUploads() const
+{
+    return m_uploads;
+}
+
+void GLFunctions::resetBufferUploads()
+{
+    m_uploads = BufferUploadStats();
+}
+
+int GLFunctions::bufferSlot(GLenum target)
+{
+    switch (target)
+    {
+        case GL_ARRAY_BUFFER: return 0;
+        case GL_ELEMENT_ARRAY_BUFFER: return 1;
+        case GL_COPY_READ_BUFFER: return 2;
+        case GL_COPY_WRITE_BUFFER: return 3;
+        case GL_TEXTURE_BUFFER: return 4;
+        case GL_UNIFORM_BUFFER: return 5;
+    }
+    return -1;
+}
+
+void GLFunctions::glUseProgram(GLuint program)
+{
+    if (program == m_boundProgram)
+    {
+        m_stateCalls.programs.elided++;
+        return;
+    }
+    m_stateCalls.programs.issued++;
+    m_boundProgram = program;
+    QOpenGLFunctions_3_2_Core::glUseProgram(program);
+}
+
+void GLFunctions::glBindVertexArray(GLuint array)
+{
+    if (array == m_boundVao)
+    {
+        m_stateCalls.vaos.elided++;
+        return;
+    }
+    m_stateCalls.vaos.issued++;
+    m_boundVao = array;
+    // The element array binding belongs to the VAO.
+    m_boundBuffers[bufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = STATE_UNKNOWN;
+    QOpenGLFunctions_3_2_Core::glBindVertexArray(array);
+}
+
+void GLFunctions::glBindBuffer(GLenum target, GLuint buffer)
+{
+    int slot = bufferSlot(target);
+    if (slot >= 0 && m_boundBuffers[slot] == buffer)
+    {
+        m_stateCalls.buffers.elided++;
+        return;
+    }
+    m_stateCalls.buffers.issued++;
+    if (slot >= 0)
+    {
+        m_boundBuffers[slot] = buffer;
+    }
+    QOpenGLFunctions_3_2_Core::glBindBuffer(target, buffer);
+}
+
+void GLFunctions::glDeleteBuffers(GLsizei n, const GLuint *buffers)
+{
+    for (GLsizei i = 0; i < n; i++)
+    {
+        for (GLuint& bound : m_boundBuffers)
+        {
+            if (bound == buffers[i])
+            {
+                bound = 0;
+            }
+        }
+    }
+    QOpenGLFunctions_3_2_Core::glDeleteBuffers(n, buffers);
+}
+
+void GLFunctions::glDeleteVertexArrays(GLsizei n, const GLuint *arrays)
+{
+    for (GLsizei i = 0; i < n; i++)
+    {
+        if (arrays[i] != 0 && arrays[i] == m_boundVao)
+        {
+            m_boundVao = 0;
+            m_boundBuffers[bufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = STATE_UNKNOWN;
+        }
+    }
+    QOpenGLFunctions_3_2_Core::glDeleteVertexArrays(n, arrays);
+}
+
+void GLFunctions::invalidateStateCache()
+{
+    m_boundProgram = STATE_UNKNOWN;
+    m_boundVao = STATE_UNKNOWN;
+    for (GLuint& bound : m_boundBuffers)
+    {
+        bound = STATE_UNKNOWN;
+    }
+}
+
+void GLFunctions::countUniform(bool issued)
+{
+    if (issued)
+    {
+        m_stateCalls.uniforms.issued++;
+    }
+    else
+    {
+        m_stateCalls.uniforms.elided++;
+    }
+}
+
+const StateCallStats& GLFunctions::stateCalls() const
+{
+    return m_stateCalls;
+}
+
+void GLFunctions::resetStateCalls()
+{
+    m_stateCalls = StateCallStats();
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <QOpenGLFunctions_3_2_Core>
+#include <QOpenGLDebugLogger>
+
+
+// How much GL error checking is done. glGetError makes many drivers wait for
+// the GPU, so checking after every call costs more the more is drawn.
+enum GLValidation
+{
+    VALIDATION_OFF,     // No checks at all
+    VALIDATION_FRAME,   // Errors are collected once per frame and summed up; KHR_debug messages arrive asynchronously
+    VALIDATION_CALL     // glGetError at every checkGL(), KHR_debug messages arrive synchronously; for debugging
+};
+
+
+// Buffer traffic through a GLFunctions.
+struct BufferUploadStats
+{
+    int allocations = 0;   // glBufferData calls, each (re)allocates a buffer's storage
+    int updates = 0;       // glBufferSubData calls into existing storage
+    long long bytes = 0;   // Bytes passed by both
+};
+
+// Calls that reached the driver, and calls the state cache dropped because
+// they would not have changed anything.
+struct StateCallCount
+{
+    int issued = 0;
+    int elided = 0;
+};
+
+struct StateCallStats
+{
+    StateCallCount programs;   // glUseProgram
+    StateCallCount vaos;       // glBindVertexArray
+    StateCallCount buffers;    // glBindBuffer
+    StateCallCount uniforms;   // glUniform*, filtered by ShaderProgram
+};
+
+// The GL 3.2 core functions with the bookkeeping every renderer here relies
+// on: uploads are counted, redundant binds are dropped and errors are checked
+// at the configured validation level. Shared by the widget (OpenGLContext) and
+// the headless renderer, which has no widget.
+class GLFunctions
+    : public QOpenGLFunctions_3_2_Core
+{
+private:
+    BufferUploadStats m_uploads;
+
+    // What the state cache believes is bound; STATE_UNKNOWN until the next bind.
+    GLuint m_boundProgram;
+    GLuint m_boundVao;
+    GLuint m_boundBuffers[6]; // See bufferSlot() for the targets
+    StateCallStats m_stateCalls;
+
+    static int bufferSlot(GLenum target);
+
+    GLValidation m_validation;
+    QOpenGLDebugLogger* mp_debugLogger; // Only set while KHR_debug is available and initialized
+    const char* m_validationSite;       // Passed to the last checkGL(), shown with debug messages
+    int m_frameMessages;                // Debug messages since the last finishFrameValidation()
+
+    // Print a GL error and, like printGLErrorLog(), throw so a debugger stops here.
+    void reportGLError(GLenum error, const char* site);
+    void debugMessageLogged(const QOpenGLDebugMessage& message);
+
+public:
+    GLFunctions();
+    virtual ~GLFunctions();
+
+    // Check for a GL error right now, whatever the validation level. For setup code.
+    void printGLErrorLog();
+    void printLinkInfoLog(int prog);
+    void printShaderInfoLog(int shader);
+
+    // The level asked for by SCENEGRAPH_GL_VALIDATION ("off", "frame" or "call"). Without
+    // it, release builds validate nothing and debug builds once per frame.
+    static GLValidation validationFromEnvironment();
+    GLValidation validation() const;
+    void setValidation(GLValidation level);
+    // Start receiving KHR_debug messages, if the context is a debug context that has
+    // the extension. Call once the GL functions are initialized.
+    void startDebugLogging();
+    // Mark the end of a group of GL calls named by site. Only VALIDATION_CALL queries
+    // glGetError here; otherwise it just records the site for later messages.
+    void checkGL(const char* site);
+    // The once-per-frame check of VALIDATION_FRAME; prints a summary if anything went wrong.
+    void finishFrameValidation();
+
+    // These hide the QOpenGLFunctions versions, so every upload made through
+    // this class is counted before it is passed on.
+    void glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage);
+    void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data);
+    // Uploads since the last resetBufferUploads(), e.g. those of the current frame.
+    const BufferUploadStats& bufferUploads() const;
+    void resetBufferUploads();
+
+    // These hide the QOpenGLFunctions versions too. Binding what is already
+    // bound is dropped; everything else is passed on and remembered.
+    void glUseProgram(GLuint program);
+    void glBindVertexArray(GLuint array);
+    void glBindBuffer(GLenum target, GLuint buffer);
+    // Deleting bound names unbinds them, which the cache has to know.
+    void glDeleteBuffers(GLsizei n, const GLuint *buffers);
+    void glDeleteVertexArrays(GLsizei n, const GLuint *arrays);
+    // Forget what is bound. Needed whenever GL is used other than through this
+    // class, as Qt does between our paintGL() calls.
+    void invalidateStateCache();
+    // ShaderProgram tells whether a uniform upload was issued or found unchanged.
+    void countUniform(bool issued);
+    // Calls since the last resetStateCalls().
+    const StateCallStats& stateCalls() const;
+    void resetStateCalls();
+};
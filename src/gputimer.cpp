@@ -0,0 +1,105 @@
+#include "gputimer.h"
+#include <QOpenGLContext>
+
+// Query objects are created this many at a time.
+static const int QUERY_BATCH = 32;
+
+GpuTimer::GpuTimer(GLFunctions* context)
+    : m_queryCounter(nullptr), m_getQueryObjectui64v(nullptr), mp_context(context)
+{}
+
+bool GpuTimer::create()
+{
+    // QOpenGLFunctions_3_2_Core stops short of the 3.3 timer query entry
+    // points, so they are looked up like an extension.
+    QOpenGLContext* ctx = QOpenGLContext::currentContext();
+    QSurfaceFormat format = ctx->format();
+    bool core33 = format.majorVersion() > 3 || (format.majorVersion() == 3 && format.minorVersion() >= 3);
+    if (!core33 && !ctx->hasExtension("GL_ARB_timer_query")) {
+        printf("GL_ARB_timer_query is not available; the profiler shows CPU times only\n");
+        return false;
+    }
+    m_queryCounter = reinterpret_cast<QueryCounterFunction>(ctx->getProcAddress("glQueryCounter"));
+    m_getQueryObjectui64v = reinterpret_cast<GetQueryObjectui64vFunction>(ctx->getProcAddress("glGetQueryObjectui64v"));
+    return m_queryCounter != nullptr && m_getQueryObjectui64v != nullptr;
+}
+
+void GpuTimer::destroy()
+{
+    if (!m_queries.empty()) {
+        mp_context->glDeleteQueries(GLsizei(m_queries.size()), m_queries.data());
+    }
+    m_queries.clear();
+    m_freeQueries.clear();
+    m_inFlight.clear();
+}
+
+GLuint GpuTimer::takeQuery()
+{
+    if (m_freeQueries.empty()) {
+        GLuint batch[QUERY_BATCH];
+        mp_context->glGenQueries(QUERY_BATCH, batch);
+        m_queries.insert(m_queries.end(), batch, batch + QUERY_BATCH);
+        m_freeQueries.insert(m_freeQueries.end(), batch, batch + QUERY_BATCH);
+    }
+    GLuint query = m_freeQueries.back();
+    m_freeQueries.pop_back();
+    return query;
+}
+
+void GpuTimer::Begin(unsigned iFrame, int iSample)
+{
+    if (m_queryCounter == nullptr) {
+        return;
+    }
+    Interval interval = {iFrame, iSample, takeQuery(), 0};
+    m_queryCounter(interval.begin, GL_TIMESTAMP);
+    m_inFlight.push_back(interval);
+}
+
+void GpuTimer::End(unsigned iFrame, int iSample)
+{
+    // Scopes end in reverse order of beginning, so the interval is near the back.
+    for (std::vector<Interval>::reverse_iterator p = m_inFlight.rbegin(); p != m_inFlight.rend(); p++) {
+        if (p->frame == iFrame && p->sample == iSample && p->end == 0) {
+            p->end = takeQuery();
+            m_queryCounter(p->end, GL_TIMESTAMP);
+            return;
+        }
+    }
+}
+
+void GpuTimer::Collect(FrameProfiler& ioProfiler)
+{
+    // Collect() runs between frames, so an interval without an end was
+    // abandoned; its frame is finished without that time.
+    size_t kept = 0;
+    for (size_t i = 0; i < m_inFlight.size(); i++) {
+        if (m_inFlight[i].end == 0) {
+            m_freeQueries.push_back(m_inFlight[i].begin);
+        } else {
+            m_inFlight[kept++] = m_inFlight[i];
+        }
+    }
+    m_inFlight.resize(kept);
+
+    // Queries complete in the order they were issued: the first end
+    // timestamp that is not available yet means none after it is either.
+    size_t done = 0;
+    for (; done < m_inFlight.size(); done++) {
+        const Interval& interval = m_inFlight[done];
+        GLint available = 0;
+        mp_context->glGetQueryObjectiv(interval.end, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+        GLuint64 begin = 0;
+        GLuint64 end = 0;
+        m_getQueryObjectui64v(interval.begin, GL_QUERY_RESULT, &begin);
+        m_getQueryObjectui64v(interval.end, GL_QUERY_RESULT, &end);
+        ioProfiler.SetDeferredTime(interval.frame, interval.sample, (end - begin) * 1e-6);
+        m_freeQueries.push_back(interval.begin);
+        m_freeQueries.push_back(interval.end);
+    }
+    m_inFlight.erase(m_inFlight.begin(), m_inFlight.begin() + done);
+}
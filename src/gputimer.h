@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glfunctions.h>
+#include <vector>
+
+#include "frameprofiler.h"
+
+// GPU times for FrameProfiler scopes from GL timestamp queries
+// (GL_ARB_timer_query, core in 3.3). A scope writes one timestamp where it
+// begins and one where it ends; timestamps nest, unlike GL_TIME_ELAPSED
+// queries. Results are only read once GL says they are available, usually
+// two or three frames later, so timing never stalls the pipeline.
+class GpuTimer
+    : public DeferredTimer
+{
+public:
+    GpuTimer(GLFunctions* context);
+
+    // Look up the timer query functions. False if the context has none; then
+    // the profiler has to do without GPU times.
+    bool create();
+    void destroy();
+
+    void Begin(unsigned iFrame, int iSample) override;
+    void End(unsigned iFrame, int iSample) override;
+    void Collect(FrameProfiler& ioProfiler) override;
+
+private:
+    typedef void (QOPENGLF_APIENTRYP QueryCounterFunction)(GLuint id, GLenum target);
+    typedef void (QOPENGLF_APIENTRYP GetQueryObjectui64vFunction)(GLuint id, GLenum pname, GLuint64* params);
+
+    struct Interval
+    {
+        unsigned frame;
+        int sample;
+        GLuint begin;
+        GLuint end; // 0 until End() is called
+    };
+
+    GLuint takeQuery();
+
+    QueryCounterFunction m_queryCounter;
+    GetQueryObjectui64vFunction m_getQueryObjectui64v;
+    std::vector<GLuint> m_queries;     // Every query object created, for destroy()
+    std::vector<GLuint> m_freeQueries; // The ones not waiting for a result
+    std::vector<Interval> m_inFlight;  // In the order they were begun
+
+    GLFunctions* mp_context;
+};
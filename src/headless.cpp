@@ -0,0 +1,145 @@
+#include "headless.h"
+#include <glfunctions.h>
+#include <scenerenderer.h>
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QSurfaceFormat>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "robotscene.h"
+#include "sceneio.h"
+
+// The value below which iPercent percent of the sorted iTimes lie.
+static double Percentile(const std::vector<double>& iTimes, double iPercent)
+{
+    size_t rank = static_cast<size_t>(std::ceil(iPercent / 100.0 * iTimes.size()));
+    return iTimes[std::min(std::max<size_t>(rank, 1), iTimes.size()) - 1];
+}
+
+int RunHeadless(const HeadlessOptions& iOptions)
+{
+    if (iOptions.frames <= 0 || iOptions.width <= 0 || iOptions.height <= 0)
+    {
+        fprintf(stderr, "Headless: frames, width and height have to be positive\n");
+        return 1;
+    }
+
+    LoadedScene scene;
+    if (iOptions.scenePath.empty())
+    {
+        scene.pool = mkU<NodePool>();
+        scene.root = &BuildRobotScene(*scene.pool);
+    }
+    else
+    {
+        std::string error;
+        if (!ReadScene(iOptions.scenePath.c_str(), scene, error))
+        {
+            fprintf(stderr, "Headless: %s: %s\n", iOptions.scenePath.c_str(), error.c_str());
+            return 1;
+        }
+    }
+
+    // The same format main() asks for the window: GL 3.2 core with a depth buffer.
+    QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+    QOffscreenSurface surface;
+    surface.setFormat(format);
+    surface.create();
+    QOpenGLContext context;
+    context.setFormat(format);
+    if (!context.create() || !context.makeCurrent(&surface))
+    {
+        fprintf(stderr, "Headless: cannot create an OpenGL context\n");
+        return 1;
+    }
+
+    int result = 0;
+    {
+        GLFunctions gl;
+        gl.initializeOpenGLFunctions();
+        gl.startDebugLogging();
+        printf("renderer %s\n", reinterpret_cast<const char*>(gl.glGetString(GL_RENDERER)));
+
+        // Depth is needed: the render queue and the instanced draws order shapes by it.
+        QOpenGLFramebufferObject framebuffer(iOptions.width, iOptions.height, QOpenGLFramebufferObject::CombinedDepthStencil);
+        if (!framebuffer.isValid())
+        {
+            fprintf(stderr, "Headless: cannot create a %dx%d framebuffer\n", iOptions.width, iOptions.height);
+            context.doneCurrent();
+            return 1;
+        }
+        framebuffer.bind();
+        gl.glViewport(0, 0, iOptions.width, iOptions.height);
+
+        SceneRenderer renderer(&gl);
+        renderer.Initialize();
+        renderer.UpdateView();
+
+        std::string error;
+        if (!iOptions.profilePath.empty() && !renderer.profiler.StartDump(iOptions.profilePath.c_str(), error))
+        {
+            fprintf(stderr, "Headless: %s\n", error.c_str());
+            renderer.Destroy();
+            context.doneCurrent();
+            return 1;
+        }
+
+        std::vector<double> times;
+        times.reserve(iOptions.frames);
+        QElapsedTimer timer;
+        for (int frame = -iOptions.warmupFrames; frame < iOptions.frames; frame++)
+        {
+            // Warmup frames are neither timed nor profiled.
+            renderer.profiler.SetEnabled(frame >= 0 && renderer.profiler.IsDumping());
+            timer.start();
+            {
+                ProfileScope scope(renderer.profiler, "frame", PROFILE_CPU_GPU);
+                renderer.RenderFrame(*scene.root);
+            }
+            gl.glFinish();
+            // After glFinish every timer query of the frame has its result,
+            // so each frame is written out as soon as it ends.
+            renderer.profiler.EndFrame();
+            if (frame >= 0)
+            {
+                times.push_back(timer.nsecsElapsed() * 1e-6);
+            }
+        }
+
+        double total = 0.0;
+        for (double t : times)
+        {
+            total += t;
+        }
+        std::sort(times.begin(), times.end());
+        printf("frames %d\n", iOptions.frames);
+        printf("width %d\n", iOptions.width);
+        printf("height %d\n", iOptions.height);
+        printf("propagation_threads %d\n",
+               renderer.settings.parallelPropagation ? renderer.GetPropagationThreadCount() : 1);
+        printf("propagation_grain %d\n", renderer.settings.propagationGrain);
+        printf("min_ms %.4f\n", times.front());
+        printf("median_ms %.4f\n", Percentile(times, 50.0));
+        printf("p99_ms %.4f\n", Percentile(times, 99.0));
+        printf("mean_ms %.4f\n", total / times.size());
+        printf("max_ms %.4f\n", times.back());
+
+        if (!iOptions.imagePath.empty() && !framebuffer.toImage().save(QString::fromStdString(iOptions.imagePath)))
+        {
+            fprintf(stderr, "Headless: cannot write %s\n", iOptions.imagePath.c_str());
+            result = 1;
+        }
+
+        renderer.Destroy();
+        framebuffer.release();
+    }
+    context.doneCurrent();
+    return result;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+// A run without any window: the scene is drawn into a framebuffer object on
+// a QOffscreenSurface. Works wherever Qt can create a GL 3.2 core context,
+// including Mesa's llvmpipe on machines without a display or GPU, e.g. with
+// QT_QPA_PLATFORM=offscreen (or under xvfb-run) and LIBGL_ALWAYS_SOFTWARE=1.
+struct HeadlessOptions
+{
+    std::string scenePath;  // Empty draws the robot scene
+    std::string imagePath;  // Where to save the last frame; empty saves nothing
+    std::string profilePath; // Where to dump the profiler's scopes of the timed frames; empty runs without it
+    int width = 800;
+    int height = 800;
+    int frames = 300;       // Frames that are timed
+    int warmupFrames = 10;  // Frames drawn before the timed ones, e.g. to compile the hierarchy
+};
+
+// Draw iOptions.frames frames and print their times: min, median, p99, mean
+// and max in milliseconds, one "key value" pair per line. A frame is timed
+// from its first GL call until glFinish returns, so GPU work counts too.
+// Returns the exit code for main().
+int RunHeadless(const HeadlessOptions& iOptions);
@@ -0,0 +1,64 @@
+#include "instancebuffer.h"
+#include <algorithm>
+
+InstanceBuffer::InstanceBuffer(GLFunctions* context)
+    : m_buffers(), m_textures(), m_capacity(), m_current(0), m_maxInstances(0),
+      mp_context(context)
+{}
+
+void InstanceBuffer::create()
+{
+    mp_context->glGenBuffers(RING_SIZE, m_buffers);
+    mp_context->glGenTextures(RING_SIZE, m_textures);
+
+    // A texture refers to the buffer object, not to its storage, so it stays
+    // attached when upload() has to grow the buffer.
+    for (int i = 0; i < RING_SIZE; i++)
+    {
+        mp_context->glBindBuffer(GL_TEXTURE_BUFFER, m_buffers[i]);
+        mp_context->glBindTexture(GL_TEXTURE_BUFFER, m_textures[i]);
+        mp_context->glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_buffers[i]);
+        m_capacity[i] = 0;
+    }
+
+    GLint maxTexels = 0;
+    mp_context->glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    m_maxInstances = maxTexels / TEXELS_PER_INSTANCE;
+}
+
+void InstanceBuffer::destroy()
+{
+    mp_context->glDeleteTextures(RING_SIZE, m_textures);
+    mp_context->glDeleteBuffers(RING_SIZE, m_buffers);
+    for (int i = 0; i < RING_SIZE; i++)
+    {
+        m_textures[i] = 0;
+        m_buffers[i] = 0;
+        m_capacity[i] = 0;
+    }
+}
+
+int InstanceBuffer::maxInstances() const
+{
+    return m_maxInstances;
+}
+
+void InstanceBuffer::upload(const glm::vec4* iTexels, int iCount)
+{
+    m_current = (m_current + 1) % RING_SIZE;
+    size_t bytes = size_t(iCount) * TEXELS_PER_INSTANCE * sizeof(glm::vec4);
+    mp_context->glBindBuffer(GL_TEXTURE_BUFFER, m_buffers[m_current]);
+    if (bytes > m_capacity[m_current])
+    {
+        // Grow geometrically, so a growing scene soon stops allocating.
+        m_capacity[m_current] = std::max(bytes, m_capacity[m_current] * 2);
+        mp_context->glBufferData(GL_TEXTURE_BUFFER, m_capacity[m_current], nullptr, GL_DYNAMIC_DRAW);
+    }
+    mp_context->glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, iTexels);
+}
+
+void InstanceBuffer::bind(int iUnit)
+{
+    mp_context->glActiveTexture(GL_TEXTURE0 + iUnit);
+    mp_context->glBindTexture(GL_TEXTURE_BUFFER, m_textures[m_current]);
+}
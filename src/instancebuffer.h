@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glfunctions.h>
+#include <la.h>
+
+// Per-instance data for glDrawElementsInstanced. OpenGL 3.2 has no instanced
+// vertex attributes (glVertexAttribDivisor is 3.3), so the records live in a
+// texture buffer and the vertex shader fetches record u_InstanceBase + gl_InstanceID.
+//
+// One record is TEXELS_PER_INSTANCE RGBA32F texels:
+//   (m0, m1, m2, m3)  the first two columns of the 2x3 world matrix
+//   (m4, m5, z, 0)    its translation and the depth that keeps the draw order
+//   (r, g, b, 0)      the color
+//
+// Uploads rotate through RING_SIZE buffers, so a frame never writes into one
+// the GPU may still be reading for an earlier frame. Storage is only
+// allocated when a buffer has to grow.
+class InstanceBuffer
+{
+public:
+    static const int TEXELS_PER_INSTANCE = 3;
+    static const int RING_SIZE = 3;
+
+    InstanceBuffer(GLFunctions* context);
+
+    void create();
+    void destroy();
+
+    // The most records a single upload can hold (GL_MAX_TEXTURE_BUFFER_SIZE).
+    int maxInstances() const;
+    // Copy iCount records starting at iTexels into the next buffer of the ring.
+    void upload(const glm::vec4* iTexels, int iCount);
+    // Bind the buffer of the last upload to texture unit iUnit.
+    void bind(int iUnit);
+
+private:
+    GLuint m_buffers[RING_SIZE];   // The buffer objects holding the records
+    GLuint m_textures[RING_SIZE];  // Their GL_TEXTURE_BUFFER views that the shader samples
+    size_t m_capacity[RING_SIZE];  // Bytes allocated in each buffer
+    int m_current;                 // The buffer written last
+    int m_maxInstances;
+
+    GLFunctions* mp_context;
+};
@@ -1,17 +1,6 @@
 #pragma once
-#define GLM_CIS460  // Don't copy this include!
-#define GLM_FORCE_RADIANS
-// Primary GLM library
-#    include <glm/glm.hpp>
-// For glm::translate, glm::rotate, and glm::scale.
-#    include <glm/gtc/matrix_transform.hpp>
-// For glm::translate, glm::rotate, and glm::scale.
-#    include <glm/gtx/matrix_transform_2d.hpp>
-// For glm::to_string.
-#    include <glm/gtx/string_cast.hpp>
-// For glm::value_ptr.
-#    include <glm/gtc/type_ptr.hpp>
-//#undef GLM_CIS460
+// GLM itself is included through the scene-graph core.
+#include <coremath.h>
 
 #include <QMatrix4x4>
 #include<QVector4D>
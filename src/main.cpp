@@ -1,8 +1,12 @@
 #include <mainwindow.h>
+#include <openglcontext.h>
+#include <headless.h>
 
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QSurfaceFormat>
 #include <QDebug>
+#include <cstdio>
 
 void debugFormatVersion()
 {
@@ -29,6 +33,9 @@ int main(int argc, char *argv[])
     format.setVersion(3, 2);
     format.setOption(QSurfaceFormat::DeprecatedFunctions, false);
     format.setProfile(QSurfaceFormat::CoreProfile);
+    format.setDepthBufferSize(24); // Instanced draws keep their painting order through depth
+    // KHR_debug messages are only sent to debug contexts.
+    if (GLFunctions::validationFromEnvironment() != VALIDATION_OFF) format.setOption(QSurfaceFormat::DebugContext);
     //format.setSamples(4);  // Uncomment for nice antialiasing. Not always supported.
 
     /*** AUTOMATIC TESTING: DO NOT MODIFY ***/
@@ -38,6 +45,40 @@ int main(int argc, char *argv[])
     QSurfaceFormat::setDefaultFormat(format);
     debugFormatVersion();
 
+    // Without a window: draw a scene a number of times and print frame times.
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption headlessOption("headless", "Render offscreen and print frame-time statistics instead of opening a window.");
+    QCommandLineOption sceneOption("scene", "Scene file to render headless; the robot if not given.", "file");
+    QCommandLineOption framesOption("frames", "Timed frames.", "count", "300");
+    QCommandLineOption warmupOption("warmup", "Untimed frames before them.", "count", "10");
+    QCommandLineOption sizeOption("size", "Framebuffer size.", "WxH", "800x800");
+    QCommandLineOption imageOption("image", "Save the last frame to this file.", "file");
+    QCommandLineOption profileOption("profile", "Write the CPU and GPU times of every scope of the timed frames to this CSV file.", "file");
+    parser.addOption(headlessOption);
+    parser.addOption(sceneOption);
+    parser.addOption(framesOption);
+    parser.addOption(warmupOption);
+    parser.addOption(sizeOption);
+    parser.addOption(imageOption);
+    parser.addOption(profileOption);
+    parser.process(a);
+    if (parser.isSet(headlessOption))
+    {
+        HeadlessOptions options;
+        options.scenePath = parser.value(sceneOption).toStdString();
+        options.imagePath = parser.value(imageOption).toStdString();
+        options.profilePath = parser.value(profileOption).toStdString();
+        options.frames = parser.value(framesOption).toInt();
+        options.warmupFrames = parser.value(warmupOption).toInt();
+        if (std::sscanf(parser.value(sizeOption).toStdString().c_str(), "%dx%d", &options.width, &options.height) != 2)
+        {
+            fprintf(stderr, "--size expects WxH, e.g. 1920x1080\n");
+            return 1;
+        }
+        return RunHeadless(options);
+    }
+
     MainWindow w;
     w.show();
 
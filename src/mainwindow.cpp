@@ -1,5 +1,7 @@
 #include "mainwindow.h"
 #include <ui_mainwindow.h>
+#include <QFileDialog>
+#include <QMessageBox>
 
 
 MainWindow::MainWindow(QWidget *parent) :
@@ -31,9 +33,11 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->addTranslateNodeBtn, SIGNAL(clicked()), this, SLOT(slot_createT()));
     connect(ui->addRotateNodeBtn, SIGNAL(clicked()), this, SLOT(slot_createR()));
     connect(ui->addScaleNodeBtn, SIGNAL(clicked()), this, SLOT(slot_createS()));
+    connect(ui->removeNodeBtn, SIGNAL(clicked()), this, SLOT(slot_removeNode()));
 
     // Wake up pinBox when a QTreeWidgetItem is selected.
     connect(ui->treeWidget, SIGNAL(itemClicked(QTreeWidgetItem* , int)), this, SLOT(slot_wakeUpPinBox(QTreeWidgetItem* , int)));
+    connect(ui->mygl, SIGNAL(NodePicked(Node*)), this, SLOT(slot_selectNode(Node*)));
 
     // Connect the geometry set btn and the setGeo()
     connect(ui->setGeoSquareBtn, SIGNAL(clicked()), this, SLOT(slot_setGeo()));
@@ -49,15 +53,79 @@ void MainWindow::on_actionQuit_triggered()
     QApplication::exit();
 }
 
+void MainWindow::on_actionOpenScene_triggered()
+{
+    QString path = QFileDialog::getOpenFileName(this, "Open Scene", QString(), "Scene files (*.sgs *.json)");
+    if (path.isEmpty())
+    {
+        return;
+    }
+    std::string error;
+    if (!ui->mygl->LoadScene(path.toLocal8Bit().constData(), error))
+    {
+        QMessageBox::warning(this, "Open Scene", QString::fromStdString(error));
+    }
+}
+
+void MainWindow::on_actionSaveScene_triggered()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Save Scene", "scene.sgs", "Scene files (*.sgs *.json)");
+    if (path.isEmpty())
+    {
+        return;
+    }
+    std::string error;
+    if (!ui->mygl->SaveScene(path.toLocal8Bit().constData(), error))
+    {
+        QMessageBox::warning(this, "Save Scene", QString::fromStdString(error));
+    }
+}
+
 void MainWindow::slot_addItemToTreeWidget()
 {
-    ui->treeWidget->addTopLevelItem(&ui->mygl->GetRoot());
+    // UI handlers are profiled too; their time counts towards the next frame.
+    ProfileScope scope(ui->mygl->GetProfiler(), "slot_addItemToTreeWidget");
+    // Also called when a scene file replaces the scene: drop the items of the old one.
+    ui->treeWidget->clear();
+    itemIndex.clear();
+    ui->treeWidget->addTopLevelItem(NodeItem::BuildTree(&ui->mygl->GetRoot(), itemIndex));
+}
+
+Node* MainWindow::CurrentNode()
+{
+    return ItemNode(ui->treeWidget->currentItem());
+}
+
+Node* MainWindow::ItemNode(QTreeWidgetItem* iItem)
+{
+    NodeItem* item = dynamic_cast<NodeItem*>(iItem);
+    return item != nullptr ? item->GetNode(ui->mygl->GetNodePool()) : nullptr;
+}
+
+void MainWindow::AddChildItem(QTreeWidgetItem* iParentItem, Node& iChild)
+{
+    NodeItem* item = new NodeItem(&iChild);
+    itemIndex[iChild.GetHandle()] = item;
+    iParentItem->addChild(item);
+}
+
+void MainWindow::slot_selectNode(Node* iNode)
+{
+    ProfileScope scope(ui->mygl->GetProfiler(), "slot_selectNode");
+    NodeItemIndex::iterator found = itemIndex.find(iNode->GetHandle());
+    if (found == itemIndex.end())
+    {
+        return;
+    }
+    ui->treeWidget->setCurrentItem(found->second);
+    slot_wakeUpPinBox(found->second, 0);
 }
 
 // According to the selected item in the widget tree, we wake up the target spin box and set value in the spin box.
 void MainWindow::slot_wakeUpPinBox(QTreeWidgetItem* iItem, int iColNum)
 {
-    Node* result = ui->mygl->TraversalFind(iItem);
+    ProfileScope scope(ui->mygl->GetProfiler(), "slot_wakeUpPinBox");
+    Node* result = ItemNode(iItem);
     Node* temp = result;
     TranslateNode* t = dynamic_cast<TranslateNode*>(temp);
     RotateNode* r = dynamic_cast<RotateNode*>(temp);
@@ -116,54 +184,59 @@ void MainWindow::slot_wakeUpPinBox(QTreeWidgetItem* iItem, int iColNum)
 }
 
 
-// Set the value in the widget tree node.
+// Set the value in the widget tree node. MyGL only draws when asked, so every edit requests a frame.
 void MainWindow::slot_setTX(double value)
 {
-    QTreeWidgetItem* current = ui->treeWidget->currentItem();
-    TranslateNode* t = dynamic_cast<TranslateNode*>(current);
+    ProfileScope scope(ui->mygl->GetProfiler(), "slot_setTX");
+    TranslateNode* t = dynamic_cast<TranslateNode*>(CurrentNode());
     if (t != nullptr)
     {
         t->SetXTranslation(float(value));
+        ui->mygl->update();
     }
 }
 
 void MainWindow::slot_setTY(double value)
 {
-    QTreeWidgetItem* current = ui->treeWidget->currentItem();
-    TranslateNode* t = dynamic_cast<TranslateNode*>(current);
+    ProfileScope scope(ui->mygl->GetProfiler(), "slot_setTY");
+    TranslateNode* t = dynamic_cast<TranslateNode*>(CurrentNode());
     if (t != nullptr)
     {
         t->SetYTranslation(float(value));
+        ui->mygl->update();
     }
 }
 
 void MainWindow::slot_setRM(double value)
 {
-    QTreeWidgetItem* current = ui->treeWidget->currentItem();
-    RotateNode* t = dynamic_cast<RotateNode*>(current);
+    ProfileScope scope(ui->mygl->GetProfiler(), "slot_setRM");
+    RotateNode* t = dynamic_cast<RotateNode*>(CurrentNode());
     if (t != nullptr)
     {
         t->SetMagnitude(float(value));
+        ui->mygl->update();
     }
 }
 
 void MainWindow::slot_setSX(double value)
 {
-    QTreeWidgetItem* current = ui->treeWidget->currentItem();
-    ScaleNode* t = dynamic_cast<ScaleNode*>(current);
+    ProfileScope scope(ui->mygl->GetProfiler(), "slot_setSX");
+    ScaleNode* t = dynamic_cast<ScaleNode*>(CurrentNode());
     if (t != nullptr)
     {
         t->SetXScalar(float(value));
+        ui->mygl->update();
     }
 }
 
 void MainWindow::slot_setSY(double value)
 {
-    QTreeWidgetItem* current = ui->treeWidget->currentItem();
-    ScaleNode* t = dynamic_cast<ScaleNode*>(current);
+    ProfileScope scope(ui->mygl->GetProfiler(), "slot_setSY");
+    ScaleNode* t = dynamic_cast<ScaleNode*>(CurrentNode());
     if (t != nullptr)
     {
         t->SetYScalar(float(value));
+        ui->mygl->update();
     }
 }
 
@@ -171,29 +244,68 @@ void MainWindow::slot_setSY(double value)
 // Create Node Under the selected node.
 void MainWindow::slot_createT()
 {
-    QTreeWidgetItem* current = ui->treeWidget->currentItem();
-    Node* n = dynamic_cast<Node*>(current);
-    n->AddChild(std::make_unique<TranslateNode>(0.f, 0.f, QString("New T")));
+    ProfileScope scope(ui->mygl->GetProfiler(), "slot_createT");
+    Node* current = CurrentNode();
+    if (current != nullptr)
+    {
+        Node& child = current->AddChild(ui->mygl->GetNodePool().CreateTranslate(0.f, 0.f, "New T"));
+        AddChildItem(ui->treeWidget->currentItem(), child);
+        ui->mygl->update();
+    }
 }
 
 void MainWindow::slot_createR()
 {
-    QTreeWidgetItem* current = ui->treeWidget->currentItem();
-    Node* n = dynamic_cast<Node*>(current);
-    n->AddChild(std::make_unique<RotateNode>(0.f, QString("New R")));
+    ProfileScope scope(ui->mygl->GetProfiler(), "slot_createR");
+    Node* current = CurrentNode();
+    if (current != nullptr)
+    {
+        Node& child = current->AddChild(ui->mygl->GetNodePool().CreateRotate(0.f, "New R"));
+        AddChildItem(ui->treeWidget->currentItem(), child);
+        ui->mygl->update();
+    }
 }
 
 void MainWindow::slot_createS()
 {
-    QTreeWidgetItem* current = ui->treeWidget->currentItem();
-    Node* n = dynamic_cast<Node*>(current);
-    n->AddChild(std::make_unique<ScaleNode>(1.f, 1.f, "New S"));
+    ProfileScope scope(ui->mygl->GetProfiler(), "slot_createS");
+    Node* current = CurrentNode();
+    if (current != nullptr)
+    {
+        Node& child = current->AddChild(ui->mygl->GetNodePool().CreateScale(1.f, 1.f, "New S"));
+        AddChildItem(ui->treeWidget->currentItem(), child);
+        ui->mygl->update();
+    }
+}
+
+void MainWindow::slot_removeNode()
+{
+    ProfileScope scope(ui->mygl->GetProfiler(), "slot_removeNode");
+    Node* n = CurrentNode();
+    // The root stays; MyGL draws from it.
+    if (n == nullptr || n->GetParent() == nullptr)
+    {
+        return;
+    }
+
+    NodeItem* item = itemIndex[n->GetHandle()];
+    NodeItem::Unregister(item, itemIndex);
+    delete item;
+    ui->mygl->GetNodePool().DestroySubtree(*n);
+    ui->mygl->update();
+
+    // The selection moved to another item; show its values instead of stale ones.
+    slot_wakeUpPinBox(ui->treeWidget->currentItem(), 0);
 }
 
 void MainWindow::slot_setGeo()
 {
-    QTreeWidgetItem* current = ui->treeWidget->currentItem();
-    Node* n = dynamic_cast<Node*>(current);
-    n->AddGeo(ui->mygl->GetRectangle());
-    n->ModifyColor(glm::vec3(0.f, 0.f, 0.f));
+    ProfileScope scope(ui->mygl->GetProfiler(), "slot_setGeo");
+    Node* n = CurrentNode();
+    if (n != nullptr)
+    {
+        n->AddGeo(GEO_RECTANGLE);
+        n->ModifyColor(glm::vec3(0.f, 0.f, 0.f));
+        ui->mygl->update();
+    }
 }
@@ -2,6 +2,7 @@
 
 #include <QMainWindow>
 #include "mygl.h"
+#include "nodeitem.h"
 
 namespace Ui {
 class MainWindow;
@@ -18,13 +19,27 @@ public:
 
 private slots:
     void on_actionQuit_triggered();
+    void on_actionOpenScene_triggered();
+    void on_actionSaveScene_triggered();
 
 private:
     Ui::MainWindow *ui;
 
+    // Handle -> tree item for every node shown in the tree widget.
+    NodeItemIndex itemIndex;
+
+    // The Node behind the item currently selected in the tree widget, or nullptr.
+    Node* CurrentNode();
+    // The Node behind iItem, or nullptr if it is not a NodeItem or its node is gone.
+    Node* ItemNode(QTreeWidgetItem* iItem);
+    // Show iChild under the item of its parent.
+    void AddChildItem(QTreeWidgetItem* iParentItem, Node& iChild);
+
 public slots:
     void slot_addItemToTreeWidget();
     void slot_wakeUpPinBox(QTreeWidgetItem* iItem, int iColNum);
+    // Select the item of a node picked in the view.
+    void slot_selectNode(Node* iNode);
 
     // Set the value in the widget tree node and the tree.
     void slot_setTX(double value);
@@ -38,6 +53,9 @@ public slots:
     void slot_createR();
     void slot_createS();
 
+    // Remove the selected node together with its subtree.
+    void slot_removeNode();
+
     // Create Geometry for a selected node.
     void slot_setGeo();
 };
@@ -1,18 +1,19 @@
 #include "mygl.h"
 #include <la.h>
 
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <QApplication>
 #include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include "robotscene.h"
 
 MyGL::MyGL(QWidget *parent)
     : OpenGLContext(parent),
-      prog_flat(this),
-      m_geomGrid(this), m_geomSquare(this, {glm::vec3(0.5f, 0.5f, 1.f),
-                                            glm::vec3(-0.5f, 0.5f, 1.f),
-                                            glm::vec3(-0.5f, -0.5f, 1.f),
-                                            glm::vec3(0.5f, -0.5f, 1.f)}),
-      m_showGrid(true)
+      renderer(this),
+      nodePool(mkU<NodePool>()), RootNode(nullptr), showProfile(false)
 {
     setFocusPolicy(Qt::StrongFocus);
 }
@@ -21,9 +22,7 @@ MyGL::~MyGL()
 {
     makeCurrent();
 
-    glDeleteVertexArrays(1, &vao);
-    m_geomSquare.destroy();
-    m_geomGrid.destroy();
+    renderer.Destroy();
 }
 
 void MyGL::initializeGL()
@@ -31,81 +30,94 @@ void MyGL::initializeGL()
     // Create an OpenGL context using Qt's QOpenGLFunctions_3_2_Core class
     // If you were programming in a non-Qt context you might use GLEW (GL Extension Wrangler)instead
     initializeOpenGLFunctions();
+    invalidateStateCache();
+    startDebugLogging();
     // Print out some information about the current OpenGL context
     debugContextVersion();
 
-    // Set a few settings/modes in OpenGL rendering
-    // glEnable(GL_DEPTH_TEST);
-    glEnable(GL_LINE_SMOOTH);
-    glEnable(GL_POLYGON_SMOOTH);
-    glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
-    glHint(GL_POLYGON_SMOOTH_HINT, GL_NICEST);
-    // Set the size with which points should be rendered
-    glPointSize(5);
-    // Set the color with which the screen is filled at the start of each render call.
-    glClearColor(0.5, 0.5, 0.5, 1);
+    renderer.Initialize();
 
-    printGLErrorLog();
-
-    // Create a Vertex Attribute Object
-    glGenVertexArrays(1, &vao);
-
-    // Create the scene geometry
-    m_geomGrid.create();
-    m_geomSquare.create();
-
-    geoRectangle = std::make_unique<RectangleGeometry>(this);
-    geoRectangle->create();
-
-    geoCircle = std::make_unique<CircleGeometry>(this);
-    geoCircle->create();
-
-    geoTrapezoid = std::make_unique<TrapezoidGeometry>(this);
-    geoTrapezoid->create();
-
-    geoShoe = std::make_unique<ShoeGeometry>(this);
-    geoShoe->create();
-
-    // Create and set up the flat lighting shader
-    prog_flat.create(":/glsl/flat.vert.glsl", ":/glsl/flat.frag.glsl");
-
-    // We have to have a VAO bound in OpenGL 3.2 Core. But if we're not
-    // using multiple VAOs, we can just bind one once.
-    glBindVertexArray(vao);
+    // SCENEGRAPH_PROFILE names a file that every profiled frame is written to.
+    QByteArray profilePath = qgetenv("SCENEGRAPH_PROFILE");
+    std::string error;
+    if (!profilePath.isEmpty() && !renderer.profiler.StartDump(profilePath.constData(), error))
+    {
+        printf("Profile: %s\n", error.c_str());
+    }
+    UpdateProfiling();
 
     // Initialize the whole scene graph;
-    RootNode = ConstructSceneGraph();
+    RootNode = &BuildRobotScene(*nodePool);
     emit SendNode();
 }
 
 void MyGL::resizeGL(int w, int h)
 {
-    glm::mat3 viewMat = glm::scale(glm::mat3(), glm::vec2(0.2, 0.2)); // Screen is -5 to 5
-
-    // Upload the view matrix to our shader (i.e. onto the graphics card)
-    prog_flat.setViewMatrix(viewMat);
+    // Qt may have used GL since the last frame.
+    invalidateStateCache();
 
-    printGLErrorLog();
+    renderer.UpdateView();
 }
 
 //This function is called by Qt any time your GL window is supposed to update
 //For example, when the function updateGL is called, paintGL is called implicitly.
 void MyGL::paintGL()
 {
-    // Clear the screen so that we only see newly drawn images
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    {
+        ProfileScope scope(renderer.profiler, "paintGL", PROFILE_CPU_GPU);
+        renderer.RenderFrame(*RootNode);
+    }
+    renderer.profiler.EndFrame();
 
-    if (m_showGrid)
+    if (showProfile)
     {
-        prog_flat.setModelMatrix(glm::mat3());
-        prog_flat.draw(*this, m_geomGrid);
+        DrawProfileOverlay();
     }
+}
 
-    // Here is a good spot to call your scene graph traversal function.
-    // Any time you want to draw an instance of geometry, call
-    // prog_flat.draw(*this, yourNonPointerGeometry);
+void MyGL::UpdateProfiling()
+{
+    renderer.profiler.SetEnabled(showProfile || renderer.profiler.IsDumping());
+}
 
-    TraversalDraw(RootNode, glm::mat3());
+void MyGL::DrawProfileOverlay()
+{
+    // The summary only changes every FrameProfiler::SUMMARY_FRAMES frames, so
+    // it stays readable in continuous mode. The frame's counters follow it.
+    std::vector<std::string> stats;
+    renderer.DescribeFrameStats(stats);
+    QPainter painter(this);
+    QFont font("Monospace", 9);
+    font.setStyleHint(QFont::TypeWriter);
+    painter.setFont(font);
+    const std::vector<ProfileSample>& summary = renderer.profiler.GetSummary();
+    int lineHeight = painter.fontMetrics().height();
+    painter.fillRect(QRect(0, 0, 360, lineHeight * (int(summary.size() + stats.size()) + 1) + 8), QColor(0, 0, 0, 160));
+    painter.setPen(QColor(255, 255, 255));
+
+    char line[128];
+    snprintf(line, sizeof(line), "%-22s %8s %8s", "scope", "cpu ms", "gpu ms");
+    painter.drawText(4, lineHeight, line);
+    int y = lineHeight;
+    for (std::vector<ProfileSample>::const_iterator s = summary.begin(); s != summary.end(); s++)
+    {
+        y += lineHeight;
+        if (s->gpuMs >= 0.0)
+        {
+            snprintf(line, sizeof(line), "%*s%-*s %8.3f %8.3f", 2 * s->depth, "", 22 - 2 * s->depth, s->name, s->cpuMs, s->gpuMs);
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "%*s%-*s %8.3f        -", 2 * s->depth, "", 22 - 2 * s->depth, s->name, s->cpuMs);
+        }
+        painter.drawText(4, y, line);
+    }
+    for (std::vector<std::string>::const_iterator s = stats.begin(); s != stats.end(); s++)
+    {
+        y += lineHeight;
+        painter.drawText(4, y, s->c_str());
+    }
+    painter.end();
 }
 
 void MyGL::keyPressEvent(QKeyEvent *e)
@@ -118,196 +130,145 @@ void MyGL::keyPressEvent(QKeyEvent *e)
         break;
 
     case(Qt::Key_G):
-        m_showGrid = !m_showGrid;
+        renderer.settings.showGrid = !renderer.settings.showGrid;
+        break;
+
+    case(Qt::Key_F):
+        renderer.settings.useFlatHierarchy = !renderer.settings.useFlatHierarchy;
+        break;
+
+    case(Qt::Key_O):
+        renderer.settings.fuseChains = !renderer.settings.fuseChains;
+        renderer.InvalidateHierarchy();
+        break;
+
+    case(Qt::Key_P):
+        renderer.settings.parallelPropagation = !renderer.settings.parallelPropagation;
+        break;
+
+    case(Qt::Key_I):
+        renderer.settings.useInstancing = !renderer.settings.useInstancing;
+        break;
+
+    case(Qt::Key_U):
+        renderer.settings.cullToView = !renderer.settings.cullToView;
+        break;
+
+    case(Qt::Key_V):
+        // Off, once per frame, after every draw.
+        makeCurrent();
+        setValidation(GLValidation((validation() + 1) % 3));
+        printf("GL validation: %s\n", validation() == VALIDATION_OFF ? "off" : validation() == VALIDATION_FRAME ? "frame" : "call");
+        break;
+
+    case(Qt::Key_H):
+        showProfile = !showProfile;
+        UpdateProfiling();
+        // The summary needs a stream of frames to average.
+        if (showProfile && !continuousRendering())
+        {
+            printf("Profiler overlay: on; press C for continuous rendering to keep it current\n");
+        }
+        break;
+
+    case(Qt::Key_R):
+        if (renderer.profiler.IsDumping())
+        {
+            renderer.profiler.StopDump();
+            printf("Profile dump: stopped\n");
+        }
+        else
+        {
+            std::string error;
+            if (renderer.profiler.StartDump("profile.csv", error))
+            {
+                printf("Profile dump: writing profile.csv\n");
+            }
+            else
+            {
+                printf("Profile dump: %s\n", error.c_str());
+            }
+        }
+        UpdateProfiling();
+        break;
+
+    case(Qt::Key_C):
+        setContinuousRendering(!continuousRendering());
+        printf("Continuous rendering: %s\n", continuousRendering() ? "on" : "off");
         break;
     }
-}
 
-uPtr<Node> MyGL::ConstructSceneGraph()
-{
-    uPtr<Node> root = std::make_unique<TranslateNode>(0.f, 0.f, QString("Root"));
-
-    // For Upper Body.
-    Node& upperBodyTRef = root->AddChild(std::make_unique<TranslateNode>(0.f, 2.f, QString("upper body T")));
-    Node& upperBodyRRef = upperBodyTRef.AddChild(std::make_unique<RotateNode>(0.f, QString("upper body R")));
-    Node& upperBodySRef = upperBodyRRef.AddChild(std::make_unique<ScaleNode>(1.f, 1.f, QString("upper body S")));
-
-
-    // For Right Leg.
-    Node& rightLegTRef = upperBodySRef.AddChild(std::make_unique<TranslateNode>(0.5f, -2.f, QString("right leg T")));
-    Node& rightLegRRef = rightLegTRef.AddChild(std::make_unique<RotateNode>(0.f, QString("right leg R")));
-    Node& rightLegSRef = rightLegRRef.AddChild(std::make_unique<ScaleNode>(1.f, 1.f, QString("right leg S")));
-
-    Node& rightShoeTRef = rightLegSRef.AddChild(std::make_unique<TranslateNode>(0.55f, -3.75f, QString("right shoe T")));
-    Node& rightForeLegTRef = rightLegSRef.AddChild(std::make_unique<TranslateNode>(0.3f, 0.25f, QString("right fore leg T")));
-    Node& rightBackLegTRef = rightLegSRef.AddChild(std::make_unique<TranslateNode>(0.3f, -1.5f, QString("right back leg T")));
-
-
-    // For Right Back Leg.
-    Node& rightBackLegRRef = rightBackLegTRef.AddChild(std::make_unique<RotateNode>(0.f, QString("right back leg R")));
-    Node& rightBackLegTInnerRef = rightBackLegRRef.AddChild(std::make_unique<TranslateNode>(-0.3f, -1.f, QString("right fore leg inner T")));
-    Node& rightBackLegSRef = rightBackLegTInnerRef.AddChild(std::make_unique<ScaleNode>(0.8f, 2.5f, QString("right back leg S")));
-    rightBackLegSRef.AddGeo(geoRectangle.get());
-    rightBackLegSRef.ModifyColor(glm::vec3(1.f, 0.5f, 0.f));
-
-    // For Right Fore Leg.
-    Node& rightForeLegRRef = rightForeLegTRef.AddChild(std::make_unique<RotateNode>(0.f, QString("right fore leg R")));
-    Node& rightForeLegTInnerRef = rightForeLegRRef.AddChild(std::make_unique<TranslateNode>(-0.3f, -1.f, QString("right fore leg inner T")));
-    Node& rightForeLegSRef = rightForeLegTInnerRef.AddChild(std::make_unique<ScaleNode>(0.8f, 2.5f, QString("right fore leg S")));
-    rightForeLegSRef.AddGeo(geoRectangle.get());
-    rightForeLegSRef.ModifyColor(glm::vec3(0.5f, 0.2f, 0.8f));
-
-    // For Right Shoe.
-    Node& rightShoeRRef = rightShoeTRef.AddChild(std::make_unique<RotateNode>(0.f, QString("right shoe R")));
-    Node& rightShoeTInnerRef = rightShoeRRef.AddChild(std::make_unique<TranslateNode>(-0.3f, -0.3f, QString("left shoe inner T")));
-    Node& rightShoeSRef = rightShoeTInnerRef.AddChild(std::make_unique<ScaleNode>(0.6f, 0.6f, QString("right shoe S")));
-    rightShoeSRef.AddGeo(geoShoe.get());
-    rightShoeSRef.ModifyColor(glm::vec3(0.0f, 0.0f, 0.0f));
-
-
-    // For left leg.
-    Node& leftLegTRef = upperBodySRef.AddChild(std::make_unique<TranslateNode>(-0.5f, -2.f, QString("left leg T")));
-    Node& leftLegRRef = leftLegTRef.AddChild(std::make_unique<RotateNode>(0.f, QString("left leg R")));
-    Node& leftLegSRef = leftLegRRef.AddChild(std::make_unique<ScaleNode>(1.f, 1.f, QString("left back leg S")));
-
-    // For Left Fore Leg.
-    Node& leftForeLegTRef = leftLegSRef.AddChild(std::make_unique<TranslateNode>(0.f, 0.25f, QString("left fore leg T")));
-    Node& leftForeLegRRef = leftForeLegTRef.AddChild(std::make_unique<RotateNode>(0.f, QString("left fore leg R")));
-    Node& leftForeLegTInnerRef = leftForeLegRRef.AddChild(std::make_unique<TranslateNode>(0.f, -1.f, QString("left fore leg inner T")));
-    Node& leftForeLegSRef = leftForeLegTInnerRef.AddChild(std::make_unique<ScaleNode>(0.8f, 2.5f, QString("left fore leg S")));
-    leftForeLegSRef.AddGeo(geoRectangle.get());
-    leftForeLegSRef.ModifyColor(glm::vec3(0.5f, 0.2f, 0.8f));
-
-    // For left Shoe.
-    Node& leftShoeTRef = leftLegSRef.AddChild(std::make_unique<TranslateNode>(-0.05f, -3.75f, QString("left shoe T")));
-    Node& leftShoeRRef = leftShoeTRef.AddChild(std::make_unique<RotateNode>(0.f, QString("left shoe R")));
-    Node& leftShoeTInnerRef = leftShoeRRef.AddChild(std::make_unique<TranslateNode>(-0.3f, -0.3f, QString("left shoe inner T")));
-    Node& leftShoeSRef = leftShoeTInnerRef.AddChild(std::make_unique<ScaleNode>(-0.6f, 0.6f, QString("right shoe S")));
-    leftShoeSRef.AddGeo(geoShoe.get());
-    leftShoeSRef.ModifyColor(glm::vec3(0.0f, 0.0f, 0.0f));
-
-    // For Left Back leg.
-    Node& leftBackLegTRef = leftLegSRef.AddChild(std::make_unique<TranslateNode>(0.f, -1.5f, QString("left back leg T")));
-    Node& leftBackLegRRef = leftBackLegTRef.AddChild(std::make_unique<RotateNode>(0.f, QString("left back leg R")));
-    Node& leftBackLegTInnerRef = leftBackLegRRef.AddChild(std::make_unique<TranslateNode>(0.f, -1.f, QString("left back leg inner T")));
-    Node& leftBackLegSRef = leftBackLegTInnerRef.AddChild(std::make_unique<ScaleNode>(0.8f, 2.5f, QString("left back leg S")));
-    leftBackLegSRef.AddGeo(geoRectangle.get());
-    leftBackLegSRef.ModifyColor(glm::vec3(1.f, 0.5f, 0.f));
-
-
-    // For Right Arm.
-    Node& rightArmTRef = upperBodySRef.AddChild(std::make_unique<TranslateNode>(0.5f, 0.5f, QString("right arm T")));
-    Node& rightArmRRef = rightArmTRef.AddChild(std::make_unique<RotateNode>(0.f, QString("right arm R")));
-    Node& rightArmSRef = rightArmRRef.AddChild(std::make_unique<ScaleNode>(1.f, 1.f, QString("right arm S")));
-
-    // For Right Fore Arm (RFA).
-    Node& RFATRef = rightArmSRef.AddChild(std::make_unique<TranslateNode>(1.5f, 0.f, QString("right fore arm T")));
-    Node& RFARRef = RFATRef.AddChild(std::make_unique<RotateNode>(0.f, QString("right fore arm R")));
-    Node& rightForeArmTInnerRef = RFARRef.AddChild(std::make_unique<TranslateNode>(0.f, -0.5f, QString("right fore arm inner T")));
-    Node& RFASRef = rightForeArmTInnerRef.AddChild(std::make_unique<ScaleNode>(0.5f, 2.0f, QString("right fore arm S")));
-    RFASRef.AddGeo(geoRectangle.get());
-    RFASRef.ModifyColor(glm::vec3(1.f, 0.5f, 0.f));
-
-    // For Right Back Arm(RBA).
-    Node& RBATRef = rightArmSRef.AddChild(std::make_unique<TranslateNode>(0.25f, 0.25f, QString("Back right Arm T")));
-    Node& RBARRef = RBATRef.AddChild(std::make_unique<RotateNode>(0.f, QString("Back right Arm R")));
-    Node& rightBackArmTInnerRef = RBARRef.AddChild(std::make_unique<TranslateNode>(0.5f, 0.f, QString("right fore arm inner T")));
-    Node& RBASRef = rightBackArmTInnerRef.AddChild(std::make_unique<ScaleNode>(2.f, 0.5f, QString("Back right Arm S")));
-    RBASRef.AddGeo(geoRectangle.get());
-    RBASRef.ModifyColor(glm::vec3(0.f, 1.f, 0.f));
-
-
-    // For Left Arm
-    Node& leftArmTRef = upperBodySRef.AddChild(std::make_unique<TranslateNode>(-1.f, 0.5f, QString("left arm T")));
-    Node& leftArmRRef = leftArmTRef.AddChild(std::make_unique<RotateNode>(0.f, QString("left arm R")));
-    Node& leftArmSRef = leftArmRRef.AddChild(std::make_unique<ScaleNode>(1.f, 1.f, QString("left arm S")));
-
-    // For Left Fore Arm (LFA).
-    Node& FLATRef = leftArmSRef.AddChild(std::make_unique<TranslateNode>(-1.f, 0.f, QString("Fore Left Arm T")));
-    Node& FLARRef = FLATRef.AddChild(std::make_unique<RotateNode>(0.f, QString("Fore Left Arm R")));
-    Node& leftForeArmTInnerRef = FLARRef.AddChild(std::make_unique<TranslateNode>(0.0f, -0.5f, QString("left fore arm inner T")));
-    Node& FLASRef = leftForeArmTInnerRef.AddChild(std::make_unique<ScaleNode>(0.5f, 2.0f, QString("Fore Left Arm S")));
-    FLASRef.AddGeo(geoRectangle.get());
-    FLASRef.ModifyColor(glm::vec3(1.f, 0.5f, 0.f));
-
-    // For Left Back Arm (LBA).
-    Node& BLATRef = leftArmSRef.AddChild(std::make_unique<TranslateNode>(-0.25f, 0.25f, QString("Back Left Arm T")));
-    Node& BLARRef = BLATRef.AddChild(std::make_unique<RotateNode>(0.f, QString("Back Left Arm R")));
-    Node& BLASRef = BLARRef.AddChild(std::make_unique<ScaleNode>(2.f, 0.5f, QString("Back Left Arm S")));
-    BLASRef.AddGeo(geoRectangle.get());
-    BLASRef.ModifyColor(glm::vec3(0.f, 1.f, 0.f));
-
-
-    // For Head.
-    Node& headTRef = upperBodySRef.AddChild(std::make_unique<TranslateNode>(0.f, 1.5f, QString("head T")));
-    Node& headSRef = headTRef.AddChild(std::make_unique<ScaleNode>(1.f, 1.f, QString("head S")));
-    headSRef.AddGeo(geoCircle.get());
-    headSRef.ModifyColor(glm::vec3(0.f, 1.f, 0.f));
-
-    // For downward body.
-    Node& downwardBodyTRef = upperBodySRef.AddChild(std::make_unique<TranslateNode>(0.f, -1.5f, QString("downward Body T")));
-    Node& downwardBodyRRef = downwardBodyTRef.AddChild(std::make_unique<RotateNode>(0.f, "downward Body R"));
-    Node& downwardBodySRef = downwardBodyRRef.AddChild(std::make_unique<ScaleNode>(1.f, 1.f, "downward Body S"));
-    downwardBodySRef.AddGeo(geoTrapezoid.get());
-    downwardBodySRef.ModifyColor(glm::vec3(1.f, 1.f, 0.f));
-
-    // For upper Body.
-    Node& upperBodyRRRef = upperBodySRef.AddChild(std::make_unique<RotateNode>(180.f, "upper Body R"));
-    Node& upperBodySSRef = upperBodyRRRef.AddChild(std::make_unique<ScaleNode>(1.f, 2.f, "upper Body S"));
-    upperBodySSRef.AddGeo(geoTrapezoid.get());
-    upperBodySSRef.ModifyColor(glm::vec3(1.f, 1.f, 0.f));
-
-    return root;
+    // Every key above changes what or how the scene is drawn.
+    update();
 }
 
-void MyGL::TraversalDraw(uPtr<Node>& iNodePtr, glm::mat3 iTransformationMat)
+void MyGL::mousePressEvent(QMouseEvent *e)
 {
-    glm::mat3 T =  iTransformationMat * iNodePtr->ComputeTransformation();
-    for (std::vector<uPtr<Node>>::iterator p = iNodePtr->childrenPtrVec.begin(); p != iNodePtr->childrenPtrVec.end(); p++)
+    if (e->button() != Qt::LeftButton || RootNode == nullptr)
     {
-        TraversalDraw(*p, T);
+        return;
     }
-
-    if (iNodePtr->GetGeoPtr() != nullptr)
+    // The view always shows the whole clip square, whatever the widget's shape.
+    glm::vec2 clip(2.f * (e->pos().x() + 0.5f) / width() - 1.f, 1.f - 2.f * (e->pos().y() + 0.5f) / height());
+    Node* picked = renderer.PickNode(*RootNode, renderer.ClipToWorld(clip));
+    if (picked != nullptr)
     {
-        prog_flat.setModelMatrix(T);
-        iNodePtr->GetGeoPtr()->setColor(iNodePtr->GetColor());
-        prog_flat.draw(*this, *iNodePtr->GetGeoPtr());
+        emit NodePicked(picked);
     }
 }
 
-Node* TraversalSupport(Node* currentPtr, QTreeWidgetItem* target)
+bool MyGL::SaveScene(const char* iPath, std::string& oError)
+{
+    return WriteScene(iPath, *RootNode, oError);
+}
+
+bool MyGL::LoadScene(const char* iPath, std::string& oError)
 {
-    if (currentPtr == target)
+    LoadedScene scene;
+    SceneImportStats stats;
+    if (!ReadScene(iPath, scene, oError, &stats))
     {
-        //std::cout << currentPtr->GetName().toStdString() << std::endl;
-        return currentPtr;
+        return false;
     }
-
-    for (std::vector<uPtr<Node>>::iterator p = currentPtr->childrenPtrVec.begin(); p != currentPtr->childrenPtrVec.end(); p++)
+    if (IsTextScene(iPath))
     {
-        Node* result = TraversalSupport(p->get(), target);
-        if (result != nullptr)
-        {
-            return result;
-        }
+        double megabytes = stats.bytes / (1024.0 * 1024.0);
+        printf("Imported %u nodes (%.1f MB)\n", stats.nodes, megabytes);
+        printf("  Parse:      %.3f s, %.1f MB/s\n", stats.parseSeconds, megabytes / std::max(stats.parseSeconds, 1e-9));
+        printf("  Node build: %.3f s, %.0f nodes/s\n", stats.buildSeconds, stats.nodes / std::max(stats.buildSeconds, 1e-9));
     }
-
-    return nullptr;
+    ReplaceScene(std::move(scene.pool), scene.root, std::move(scene.file));
+    return true;
 }
 
-Node* MyGL::TraversalFind(QTreeWidgetItem* target)
+void MyGL::ReplaceScene(uPtr<NodePool> ioPool, Node* iRoot, uPtr<SceneFile> iFile)
 {
-    return TraversalSupport(this->RootNode.get(), target);
+    // The old nodes may borrow their names from the old mapping, so they go first.
+    renderer.InvalidateHierarchy();
+    nodePool = std::move(ioPool);
+    sceneFile = std::move(iFile);
+    RootNode = iRoot;
+
+    emit SendNode();
+    update();
 }
 
 Node& MyGL::GetRoot()
 {
-    return *RootNode.get();
+    return *RootNode;
+}
+
+NodePool& MyGL::GetNodePool()
+{
+    return *nodePool;
 }
 
-RectangleGeometry* MyGL::GetRectangle()
+FrameProfiler& MyGL::GetProfiler()
 {
-    return geoRectangle.get();
+    return renderer.profiler;
 }
 
+Polygon2D* MyGL::GetGeometry(GeometryId iGeoId)
+{
+    return renderer.GetGeometry(iGeoId);
+}
@@ -2,60 +2,61 @@
 
 #include <openglcontext.h>
 #include <utils.h>
-#include <shaderprogram.h>
-#include <scene/grid.h>
-#include <scene/polygon.h>
-#include "drawable.h"
+#include <scenerenderer.h>
 
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLShaderProgram>
 
 #include "node.h"
-
+#include "nodepool.h"
+#include "sceneio.h"
 
 class MyGL
     : public OpenGLContext
 {
     Q_OBJECT
 private:
-    ShaderProgram prog_flat;// A shader program that uses "flat" reflection (no shadowing at all)
-
-    Grid m_geomGrid;        // The instance of the object used to render the 5x5 grid
-    Polygon2D m_geomSquare; // The singular instance of our square object that can be re-drawn with different colors
-                            // to create the appearance of there being multiple squares
-
-    bool m_showGrid; // Read in paintGL to determine whether or not to draw the grid.
-
-    GLuint vao; // A handle for our vertex array object. This will store the VBOs created in our geometry classes.
-
-    uPtr<Node> RootNode;
+    SceneRenderer renderer; // Draws the scene; everything GL lives in there.
 
-    uPtr<RectangleGeometry> geoRectangle;
-    uPtr<CircleGeometry> geoCircle;
-    uPtr<TrapezoidGeometry> geoTrapezoid;
-    uPtr<ShoeGeometry> geoShoe;
+    uPtr<NodePool> nodePool; // Owns every node of the scene. Replaced as a whole when a scene is loaded.
+    uPtr<SceneFile> sceneFile; // Mapping of the loaded binary scene; the nodes' names point into it.
+    Node* RootNode;
+    bool showProfile; // Draw the profiler's summary over the scene.
 
+    // The profiler runs while its overlay is shown or it writes a dump.
+    void UpdateProfiling();
+    void DrawProfileOverlay();
 
 public:
     explicit MyGL(QWidget *parent = 0);
     ~MyGL();
 
     Node& GetRoot();
-    RectangleGeometry* GetRectangle();
+    NodePool& GetNodePool();
+    Polygon2D* GetGeometry(GeometryId iGeoId);
+    // Where the UI's handlers add their scopes.
+    FrameProfiler& GetProfiler();
 
     void initializeGL();
     void resizeGL(int w, int h);
     void paintGL();
-    void TraversalDraw(uPtr<Node>& iNodePtr, glm::mat3 iTransformationMat);
-    Node* TraversalFind(QTreeWidgetItem* target);
-    uPtr<Node> ConstructSceneGraph();
+
+    // Write the current scene to iPath, or replace it with the one in iPath. Files
+    // ending in ".json" use the text format (scenetext.h), all others the binary one.
+    // On failure oError says why and the current scene is kept.
+    bool SaveScene(const char* iPath, std::string& oError);
+    bool LoadScene(const char* iPath, std::string& oError);
 
 public slots:
 
 signals:
     void SendNode();
+    // A click landed on the shape of iNode.
+    void NodePicked(Node* iNode);
 protected:
     void keyPressEvent(QKeyEvent *e);
+    void mousePressEvent(QMouseEvent *e);
+private:
+    // Make iRoot, whose nodes live in ioPool, the scene. iFile is the mapping they borrow names from, if any.
+    void ReplaceScene(uPtr<NodePool> ioPool, Node* iRoot, uPtr<SceneFile> iFile);
 };
-
-
@@ -0,0 +1,42 @@
+#include "nodeitem.h"
+#include "nodepool.h"
+
+NodeItem::NodeItem(Node* iNodePtr)
+    : QTreeWidgetItem(), handle(iNodePtr->GetHandle())
+{
+    this->setText(0, QString::fromUtf8(iNodePtr->GetName()));
+}
+
+NodeHandle NodeItem::GetHandle() const
+{
+    return handle;
+}
+
+Node* NodeItem::GetNode(NodePool& iPool) const
+{
+    return iPool.Get(handle);
+}
+
+NodeItem* NodeItem::BuildTree(Node* iNodePtr, NodeItemIndex& ioIndex)
+{
+    NodeItem* item = new NodeItem(iNodePtr);
+    ioIndex[item->handle] = item;
+    for (Node* p = iNodePtr->GetFirstChild(); p != nullptr; p = p->GetNextSibling())
+    {
+        item->addChild(BuildTree(p, ioIndex));
+    }
+    return item;
+}
+
+void NodeItem::Unregister(NodeItem* iItem, NodeItemIndex& ioIndex)
+{
+    ioIndex.erase(iItem->handle);
+    for (int i = 0; i < iItem->childCount(); i++)
+    {
+        NodeItem* child = dynamic_cast<NodeItem*>(iItem->child(i));
+        if (child != nullptr)
+        {
+            Unregister(child, ioIndex);
+        }
+    }
+}
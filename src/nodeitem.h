@@ -0,0 +1,32 @@
+#pragma once
+#include "node.h"
+#include <QTreeWidgetItem>
+#include <unordered_map>
+
+class NodeItem;
+class NodePool;
+
+// Node handle -> the item that shows it. Kept in sync whenever items are created
+// or deleted, so the tree never has to be searched for a node.
+typedef std::unordered_map<NodeHandle, NodeItem*> NodeItemIndex;
+
+// The tree widget's view of a scene-graph Node. The Node itself lives in the
+// GUI-free core; this item only shows its name and keeps the node's handle.
+class NodeItem : public QTreeWidgetItem
+{
+public:
+    NodeItem(Node* iNodePtr);
+    ~NodeItem(){}
+
+    NodeHandle GetHandle() const;
+    // Resolve the handle in the pool; nullptr if the node has been destroyed.
+    Node* GetNode(NodePool& iPool) const;
+
+    // Create an item for iNodePtr and, recursively, for all of its children,
+    // registering every new item in ioIndex.
+    static NodeItem* BuildTree(Node* iNodePtr, NodeItemIndex& ioIndex);
+    // Remove iItem and all of its descendants from ioIndex.
+    static void Unregister(NodeItem* iItem, NodeItemIndex& ioIndex);
+private:
+    NodeHandle handle;
+};
@@ -9,7 +9,7 @@
 
 
 OpenGLContext::OpenGLContext(QWidget *parent)
-    : QOpenGLWidget(parent)
+    : QOpenGLWidget(parent), m_continuous(false)
 {
     // Check whether automatic testing is enabled
     autotesting = qgetenv("CIS277_AUTOTESTING") != nullptr;
@@ -21,10 +21,10 @@ OpenGLContext::OpenGLContext(QWidget *parent)
         /***/ timer.setSingleShot(true);
         /***/ timer.start(0);
     } else {
-        // Allow the timer to redraw the window
-        connect(&timer, SIGNAL(timeout()), this, SLOT(timerUpdate()));
-        // Tell the timer to redraw 60 times per second
-        timer.start(16);
+        // Frames are drawn on demand: whoever changes what is shown calls update().
+        // Only in continuous mode does every finished frame ask for the next one.
+        connect(this, SIGNAL(frameSwapped()), this, SLOT(nextFrame()));
+        m_continuous = qgetenv("SCENEGRAPH_CONTINUOUS") != nullptr;
     }
 }
 
@@ -86,79 +86,6 @@ void OpenGLContext::debugContextVersion()
     }
 }
 
-void OpenGLContext::printGLErrorLog()
-{
-    GLenum error = glGetError();
-    if (error != GL_NO_ERROR) {
-        std::cerr << "OpenGL error " << error << ": ";
-        const char *e =
-            error == GL_INVALID_OPERATION             ? "GL_INVALID_OPERATION" :
-            error == GL_INVALID_ENUM                  ? "GL_INVALID_ENUM" :
-            error == GL_INVALID_VALUE                 ? "GL_INVALID_VALUE" :
-            error == GL_INVALID_INDEX                 ? "GL_INVALID_INDEX" :
-            error == GL_INVALID_OPERATION             ? "GL_INVALID_OPERATION" :
-            QString::number(error).toUtf8().constData();
-        std::cerr << e << std::endl;
-        // Throwing here allows us to use the debugger to track down the error.
-#ifndef __APPLE__
-        // Don't do this on OS X.
-        // http://lists.apple.com/archives/mac-opengl/2012/Jul/msg00038.html
-        throw;
-#endif
-    }
-}
-
-void OpenGLContext::printLinkInfoLog(int prog)
-{
-    GLint linked;
-    glGetProgramiv(prog, GL_LINK_STATUS, &linked);
-    if (linked == GL_TRUE) {
-        return;
-    }
-    std::cerr << "GLSL LINK ERROR" << std::endl;
-
-    int infoLogLen = 0;
-    int charsWritten = 0;
-    GLchar *infoLog;
-
-    glGetProgramiv(prog, GL_INFO_LOG_LENGTH, &infoLogLen);
-
-    if (infoLogLen > 0) {
-        infoLog = new GLchar[infoLogLen];
-        // error check for fail to allocate memory omitted
-        glGetProgramInfoLog(prog, infoLogLen, &charsWritten, infoLog);
-        std::cerr << "InfoLog:" << std::endl << infoLog << std::endl;
-        delete[] infoLog;
-    }
-    // Throwing here allows us to use the debugger to track down the error.
-    throw;
-}
-
-void OpenGLContext::printShaderInfoLog(int shader)
-{
-    GLint compiled;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
-    if (compiled == GL_TRUE) {
-        return;
-    }
-    std::cerr << "GLSL COMPILE ERROR" << std::endl;
-
-    int infoLogLen = 0;
-    int charsWritten = 0;
-    GLchar *infoLog;
-
-    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLogLen);
-
-    if (infoLogLen > 0) {
-        infoLog = new GLchar[infoLogLen];
-        // error check for fail to allocate memory omitted
-        glGetShaderInfoLog(shader, infoLogLen, &charsWritten, infoLog);
-        std::cerr << "InfoLog:" << std::endl << infoLog << std::endl;
-        delete[] infoLog;
-    }
-    // Throwing here allows us to use the debugger to track down the error.
-    throw;
-}
 
 /*** AUTOMATIC TESTING: DO NOT MODIFY ***/
 /***/ void OpenGLContext::saveImageAndQuit() {
@@ -168,12 +95,27 @@ void OpenGLContext::printShaderInfoLog(int shader)
 /***/     QApplication::quit();
 /***/ }
 
-void OpenGLContext::timerUpdate()
+bool OpenGLContext::continuousRendering() const
+{
+    return m_continuous;
+}
+
+void OpenGLContext::setContinuousRendering(bool continuous)
 {
-    // This function is called roughly 60 times per second.
-    // Use it to update your scene and then tell it to redraw.
+    m_continuous = continuous;
+    // Starts the chain of frames; nextFrame() keeps it going.
+    update();
+}
+
+void OpenGLContext::nextFrame()
+{
+    // This function is called after every frame in continuous mode, as fast
+    // as the buffer swaps allow (usually the display's refresh rate).
+    // Use it to update an animated scene and then tell it to redraw.
     // (Don't update your scene in paintGL, because it
     // sometimes gets called automatically by Qt.)
 
-    update();
+    if (m_continuous) {
+        update();
+    }
 }
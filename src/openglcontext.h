@@ -1,19 +1,21 @@
 #pragma once
 
+#include <glfunctions.h>
 #include <QOpenGLWidget>
-#include <QOpenGLFunctions_3_2_Core>
 #include <QTimer>
 
 
 class OpenGLContext
     : public QOpenGLWidget,
-      public QOpenGLFunctions_3_2_Core
+      public GLFunctions
 {
     Q_OBJECT
 
 private:
-    /// Timer for drawing new frames
+    /// Timer for the automatic testing frame
     QTimer timer;
+    /// Draw frame after frame instead of only when update() is called
+    bool m_continuous;
 
 protected:
     /*** AUTOMATIC TESTING: DO NOT MODIFY ***/
@@ -25,14 +27,18 @@ public:
     ~OpenGLContext();
 
     void debugContextVersion();
-    void printGLErrorLog();
-    void printLinkInfoLog(int prog);
-    void printShaderInfoLog(int shader);
+
+    // Rendering is demand-driven: a frame is drawn when update() is called, e.g.
+    // after a scene edit, or when Qt needs one, e.g. on resize. Continuous
+    // rendering draws frames back to back instead, for animations and benchmarks.
+    // SCENEGRAPH_CONTINUOUS turns it on from the start.
+    bool continuousRendering() const;
+    void setContinuousRendering(bool continuous);
 
 private slots:
     /*** AUTOMATIC TESTING: DO NOT MODIFY ***/
     /***/ void saveImageAndQuit();
 
-    /// Slot that gets called ~60 times per second
-    void timerUpdate();
+    /// Slot that gets called after every frame; asks for another one in continuous mode
+    void nextFrame();
 };
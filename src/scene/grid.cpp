@@ -4,7 +4,7 @@
 
 const static int NUM_IDX = 36;
 
-Grid::Grid(OpenGLContext *context) : Drawable(context)
+Grid::Grid(GLFunctions *context) : Drawable(context)
 {}
 
 void Grid::create()
@@ -41,12 +41,11 @@ void Grid::create()
 
     // Create a VBO on our GPU and store its handle in bufIdx
     generateIdx();
-    // Tell OpenGL that we want to perform subsequent operations on the VBO referred to by bufIdx
-    // and that it will be treated as an element array buffer (since it will contain triangle indices)
-    mp_context->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_bufIdx);
-    // Pass the data stored in cyl_idx into the bound buffer, reading a number of bytes equal to
-    // CYL_IDX_COUNT multiplied by the size of a GLuint. This data is sent to the GPU to be read by shader programs.
-    mp_context->glBufferData(GL_ELEMENT_ARRAY_BUFFER, NUM_IDX * sizeof(GLuint), idx, GL_STATIC_DRAW);
+    // No VAO is bound yet, and without one a core profile has no GL_ELEMENT_ARRAY_BUFFER
+    // binding to upload through. createVao() binds the buffer as the VAO's element array.
+    mp_context->glBindBuffer(GL_COPY_WRITE_BUFFER, m_bufIdx);
+    // Pass the indices into the bound buffer. This data is sent to the GPU to be read by shader programs.
+    mp_context->glBufferData(GL_COPY_WRITE_BUFFER, NUM_IDX * sizeof(GLuint), idx, GL_STATIC_DRAW);
 
     // The next few sets of function calls are basically the same as above, except bufPos and bufNor are
     // array buffers rather than element array buffers, as they store vertex attributes like position.
@@ -57,6 +56,8 @@ void Grid::create()
     generateCol();
     mp_context->glBindBuffer(GL_ARRAY_BUFFER, m_bufCol);
     mp_context->glBufferData(GL_ARRAY_BUFFER, NUM_IDX * sizeof(glm::vec3), vertCol, GL_STATIC_DRAW);
+
+    createVao();
 }
 
 GLenum Grid::drawMode()
@@ -9,7 +9,7 @@
 class Grid : public Drawable
 {
 public:
-    Grid(OpenGLContext* context);
+    Grid(GLFunctions* context);
     void create() override;
 
     GLenum drawMode() override;
@@ -2,11 +2,11 @@
 #include <glm/gtx/matrix_transform_2d.hpp>
 
 
-Polygon2D::Polygon2D(OpenGLContext* context)
+Polygon2D::Polygon2D(GLFunctions* context)
     : Drawable(context), m_vertPos(), m_vertIdx(), m_numVertices(0)
 {}
 
-Polygon2D::Polygon2D(OpenGLContext* context, int numSides)
+Polygon2D::Polygon2D(GLFunctions* context, int numSides)
     : Drawable(context), m_vertPos(), m_vertIdx(), m_numVertices(numSides)
 {
     // Vertex positions
@@ -27,7 +27,7 @@ Polygon2D::Polygon2D(OpenGLContext* context, int numSides)
     }
 }
 
-Polygon2D::Polygon2D(OpenGLContext* context, const std::vector<glm::vec3>& positions)
+Polygon2D::Polygon2D(GLFunctions* context, const std::vector<glm::vec3>& positions)
     : Drawable(context), m_vertPos(positions), m_vertIdx(), m_numVertices(positions.size())
 {
     int n = m_numVertices - 2;
@@ -48,38 +48,42 @@ void Polygon2D::create()
 
     // Create a VBO on our GPU and store its handle in bufIdx
     generateIdx();
-    // Tell OpenGL that we want to perform subsequent operations on the VBO referred to by bufIdx
-    // and that it will be treated as an element array buffer (since it will contain triangle indices)
-    mp_context->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_bufIdx);
-    // Pass the data stored in cyl_idx into the bound buffer, reading a number of bytes equal to
-    // the number of indices multiplied by the size of a GLuint. This data is sent to the GPU to be read by shader programs.
-    mp_context->glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_count * sizeof(GLuint), m_vertIdx.data(), GL_STATIC_DRAW);
+    // No VAO is bound yet, and without one a core profile has no GL_ELEMENT_ARRAY_BUFFER
+    // binding to upload through. createVao() binds the buffer as the VAO's element array.
+    mp_context->glBindBuffer(GL_COPY_WRITE_BUFFER, m_bufIdx);
+    // Pass the indices into the bound buffer. This data is sent to the GPU to be read by shader programs.
+    mp_context->glBufferData(GL_COPY_WRITE_BUFFER, m_count * sizeof(GLuint), m_vertIdx.data(), GL_STATIC_DRAW);
 
     generatePos();
     mp_context->glBindBuffer(GL_ARRAY_BUFFER, m_bufPos);
     mp_context->glBufferData(GL_ARRAY_BUFFER, m_numVertices * sizeof(glm::vec3), m_vertPos.data(), GL_STATIC_DRAW);
 
+    createVao();
+
     // Free up memory now that we no longer need the vertex info to be stored on the CPU
     m_vertIdx.clear();
     m_vertPos.clear();
 }
 
-void Polygon2D::setColor(glm::vec3 c)
+void Polygon2D::createInArena(GeometryArena& iArena)
 {
-    if (!bindCol())
-    {
-        generateCol();
-    }
-    std::vector<glm::vec3> colors(m_numVertices);
-    std::fill(colors.begin(), colors.end(), c);
-    mp_context->glBindBuffer(GL_ARRAY_BUFFER, m_bufCol);
-    mp_context->glBufferData(GL_ARRAY_BUFFER, m_numVertices * sizeof(glm::vec3), colors.data(), GL_STATIC_DRAW);
+    m_count = m_vertIdx.size();
+    m_numVertices = m_vertPos.size();
+    m_mesh = iArena.add(m_vertPos, m_vertIdx, drawMode());
+
+    m_vertIdx.clear();
+    m_vertPos.clear();
+}
+
+const ArenaMesh& Polygon2D::mesh() const
+{
+    return m_mesh;
 }
 
 ///********************************************************
 /// RectangleGeometry
 ///********************************************************
-RectangleGeometry::RectangleGeometry(OpenGLContext* context)
+RectangleGeometry::RectangleGeometry(GLFunctions* context)
     : Polygon2D (
           context,
          {glm::vec3(0.5f, 0.5f, 1.f),
@@ -105,7 +109,7 @@ void RectangleGeometry::SetRectangle(std::array<glm::vec3, 4>& iVertices)
 ///********************************************************
 /// CircleGeometry
 ///********************************************************
-CircleGeometry::CircleGeometry(OpenGLContext* context)
+CircleGeometry::CircleGeometry(GLFunctions* context)
     : Polygon2D(context, 20)
 {}
 
@@ -121,7 +125,7 @@ CircleGeometry::~CircleGeometry()
 ///********************************************************
 /// TrapezoidGeometry
 ///********************************************************
-TrapezoidGeometry::TrapezoidGeometry(OpenGLContext* context)
+TrapezoidGeometry::TrapezoidGeometry(GLFunctions* context)
     : Polygon2D(
           context,
           {glm::vec3(0.5f, 0.5f, 1.f),
@@ -142,7 +146,7 @@ TrapezoidGeometry::~TrapezoidGeometry()
 ///********************************************************
 /// ShoeGeometry
 ///********************************************************
-ShoeGeometry::ShoeGeometry(OpenGLContext* context)
+ShoeGeometry::ShoeGeometry(GLFunctions* context)
     : Polygon2D (context)
 {
     m_vertPos = {
@@ -1,22 +1,25 @@
 #pragma once
 #include "drawable.h"
+#include "geometryarena.h"
 #include <iostream>
 class Polygon2D : public Drawable
 {
 public:
     // Instantiate an empty Polygon
-    Polygon2D(OpenGLContext* context);
+    Polygon2D(GLFunctions* context);
     // Instantiate a regular polygon with N sides and
     // a bounding box of side length 1 centered at the origin
-    Polygon2D(OpenGLContext* context, int numSides);
+    Polygon2D(GLFunctions* context, int numSides);
     // Instantiate a polygon with its vertex positions defined
     // in counter-clockwise order. These vertices must form a convex
     // polygon in order to be drawn correctly.
-    Polygon2D(OpenGLContext* context, const std::vector<glm::vec3>& positions);
+    Polygon2D(GLFunctions* context, const std::vector<glm::vec3>& positions);
     // Initialize data required by OpenGL to render the shape
     void create() override;
-    // Set the color of the polygon when it's drawn by OpenGL
-    void setColor(glm::vec3 c);
+    // Like create(), but put the shape into iArena instead of buffers of its own
+    void createInArena(GeometryArena& iArena);
+    // Where createInArena() put the shape
+    const ArenaMesh& mesh() const;
 
     void show(){
         for (std::vector<glm::vec3>::iterator p = m_vertPos.begin(); p != m_vertPos.end(); p++) {
@@ -30,16 +33,16 @@ protected:
     // The order in which vertices should be read to assemble triangles
     // that, all together, form the polygon.
     std::vector<GLuint> m_vertIdx;
-    // How many vertices compose this Polygon. Read by setColor
-    // in order to know how many vertices need to be assigned the
-    // Polygon's color.
+    // How many vertices compose this Polygon. The color is not stored per
+    // vertex; ShaderProgram::setColor() passes it for each draw.
     unsigned int m_numVertices;
+    ArenaMesh m_mesh;
 };
 
 class RectangleGeometry : public Polygon2D
 {
 public:
-    RectangleGeometry(OpenGLContext* context);
+    RectangleGeometry(GLFunctions* context);
     ~RectangleGeometry();
     void SetRectangle(std::array<glm::vec3, 4>& iVertices);
 private:
@@ -49,7 +52,7 @@ private:
 class CircleGeometry : public Polygon2D
 {
 public:
-    CircleGeometry(OpenGLContext* context);
+    CircleGeometry(GLFunctions* context);
     ~CircleGeometry();
 private:
 };
@@ -57,7 +60,7 @@ private:
 class TrapezoidGeometry : public Polygon2D
 {
 public:
-    TrapezoidGeometry(OpenGLContext* context);
+    TrapezoidGeometry(GLFunctions* context);
     ~TrapezoidGeometry();
 private:
 };
@@ -65,6 +68,6 @@ private:
 class ShoeGeometry : public Polygon2D
 {
 public:
-    ShoeGeometry(OpenGLContext* context);
+    ShoeGeometry(GLFunctions* context);
     ~ShoeGeometry();
 };
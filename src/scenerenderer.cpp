@@ -0,0 +1,495 @@
+#include "scenerenderer.h"
+#include <la.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// Sort key fields of the queued draws; see RenderQueue.
+static const unsigned int RENDER_LAYER_SCENE = 1;
+static const unsigned int RENDER_PROGRAM_FLAT = 0;
+
+// The integer in the environment variable iName, or iDefault if it is not set or not a number.
+static int IntFromEnvironment(const char* iName, int iDefault)
+{
+    bool ok = false;
+    int value = qgetenv(iName).toInt(&ok);
+    return ok ? value : iDefault;
+}
+
+SceneRenderer::SceneRenderer(GLFunctions* context)
+    : prog_flat(context), prog_instanced(context),
+      m_geomGrid(context), m_geomSquare(context, {glm::vec3(0.5f, 0.5f, 1.f),
+                                               glm::vec3(-0.5f, 0.5f, 1.f),
+                                               glm::vec3(-0.5f, -0.5f, 1.f),
+                                               glm::vec3(0.5f, -0.5f, 1.f)}),
+      geometryTable(), geometryArena(context), instanceBuffer(context),
+      gpuTimer(context), mp_context(context)
+{
+    settings.propagationThreads = IntFromEnvironment("SCENEGRAPH_PROPAGATION_THREADS", settings.propagationThreads);
+    settings.propagationGrain = IntFromEnvironment("SCENEGRAPH_PROPAGATION_GRAIN", settings.propagationGrain);
+}
+
+void SceneRenderer::Initialize()
+{
+    // Set a few settings/modes in OpenGL rendering
+    // mp_context->glEnable(GL_DEPTH_TEST);
+    mp_context->glEnable(GL_LINE_SMOOTH);
+    mp_context->glEnable(GL_POLYGON_SMOOTH);
+    mp_context->glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+    mp_context->glHint(GL_POLYGON_SMOOTH_HINT, GL_NICEST);
+    // Set the size with which points should be rendered
+    mp_context->glPointSize(5);
+    // Set the color with which the screen is filled at the start of each render call.
+    mp_context->glClearColor(0.5, 0.5, 0.5, 1);
+
+    mp_context->printGLErrorLog();
+
+    // Create the scene geometry. Every Drawable and the arena capture their own
+    // vertex array object; drawing binds it.
+    m_geomGrid.create();
+    m_geomSquare.create();
+
+    // The shapes of the scene share one vertex and one index buffer.
+    geometryArena.create();
+
+    geoRectangle = std::make_unique<RectangleGeometry>(mp_context);
+    geoRectangle->createInArena(geometryArena);
+
+    geoCircle = std::make_unique<CircleGeometry>(mp_context);
+    geoCircle->createInArena(geometryArena);
+
+    geoTrapezoid = std::make_unique<TrapezoidGeometry>(mp_context);
+    geoTrapezoid->createInArena(geometryArena);
+
+    geoShoe = std::make_unique<ShoeGeometry>(mp_context);
+    geoShoe->createInArena(geometryArena);
+
+    // Map the geometry ids used by the scene graph to the shapes we just created.
+    geometryTable[GEO_NONE] = nullptr;
+    geometryTable[GEO_RECTANGLE] = geoRectangle.get();
+    geometryTable[GEO_CIRCLE] = geoCircle.get();
+    geometryTable[GEO_TRAPEZOID] = geoTrapezoid.get();
+    geometryTable[GEO_SHOE] = geoShoe.get();
+
+    // Create and set up the flat lighting shader
+    prog_flat.create(":/glsl/flat.vert.glsl", ":/glsl/flat.frag.glsl");
+
+    // The instanced variant shares the fragment shader and reads its instances from texture unit 0.
+    prog_instanced.create(":/glsl/instanced.vert.glsl", ":/glsl/flat.frag.glsl");
+    prog_instanced.setInstanceUnit(0);
+    instanceBuffer.create();
+
+    if (gpuTimer.create())
+    {
+        profiler.SetDeferredTimer(&gpuTimer);
+    }
+}
+
+void SceneRenderer::Destroy()
+{
+    profiler.SetDeferredTimer(nullptr);
+    gpuTimer.destroy();
+    instanceBuffer.destroy();
+    geometryArena.destroy();
+    m_geomSquare.destroy();
+    m_geomGrid.destroy();
+}
+
+void SceneRenderer::UpdateView()
+{
+    Affine2x3 viewMat = Affine2x3::FromMat3(glm::scale(glm::mat3(), glm::vec2(0.2, 0.2))); // Screen is -5 to 5
+
+    // Upload the view matrix to our shader (i.e. onto the graphics card)
+    prog_flat.setViewMatrix(viewMat);
+    prog_instanced.setViewMatrix(viewMat);
+
+    // Whatever maps into the -1 to 1 clip square is visible.
+    inverseView = Affine2x3::FromMat3(glm::inverse(viewMat.ToMat3()));
+    viewBounds = TransformBounds(Aabb2::FromMinMax(-1.f, -1.f, 1.f, 1.f), inverseView);
+
+    mp_context->printGLErrorLog();
+}
+
+void SceneRenderer::RenderFrame(Node& iRoot)
+{
+    mp_context->resetBufferUploads();
+    // Qt binds its own framebuffer, buffers and programs between frames, so
+    // the cache starts every frame knowing nothing.
+    mp_context->invalidateStateCache();
+    mp_context->resetStateCalls();
+
+    // Clear the screen so that we only see newly drawn images
+    mp_context->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    if (settings.showGrid)
+    {
+        ProfileScope scope(profiler, "grid", PROFILE_CPU_GPU);
+        prog_flat.setModelMatrix(Affine2x3::Identity());
+        prog_flat.setColor(glm::vec3(1.f));
+        prog_flat.draw(*mp_context, m_geomGrid);
+    }
+
+    renderQueue.Clear();
+    queuedDraws.clear();
+    cullStats = CullStats();
+    if (settings.useFlatHierarchy)
+    {
+        ProfileScope scope(profiler, "FlatDraw");
+        FlatDraw(iRoot);
+    }
+    else
+    {
+        // Transforms and colors are gathered in the same walk, so they share a scope.
+        ProfileScope scope(profiler, "TraversalDraw");
+        TraversalDraw(&iRoot);
+    }
+    {
+        ProfileScope scope(profiler, "SubmitQueue", PROFILE_CPU_GPU);
+        SubmitQueue();
+    }
+
+    mp_context->finishFrameValidation();
+}
+
+void SceneRenderer::DescribeFrameStats(std::vector<std::string>& oLines) const
+{
+    // Every buffer upload goes through GLFunctions, which counts them.
+    const BufferUploadStats& u = mp_context->bufferUploads();
+    const StateCallStats& s = mp_context->stateCalls();
+    const RenderQueueStats& q = renderQueue.GetStats();
+    char line[128];
+    oLines.clear();
+    snprintf(line, sizeof(line), "uploads: %d allocs, %d updates, %lld bytes", u.allocations, u.updates, u.bytes);
+    oLines.push_back(line);
+    snprintf(line, sizeof(line), "programs %d/%d, VAOs %d/%d issued/elided", s.programs.issued, s.programs.elided,
+             s.vaos.issued, s.vaos.elided);
+    oLines.push_back(line);
+    snprintf(line, sizeof(line), "buffers %d/%d, uniforms %d/%d issued/elided", s.buffers.issued, s.buffers.elided,
+             s.uniforms.issued, s.uniforms.elided);
+    oLines.push_back(line);
+    snprintf(line, sizeof(line), "queue: %u draws, %u state changes of %u", q.packets, q.stateChangesSorted,
+             q.stateChangesPushed);
+    oLines.push_back(line);
+    snprintf(line, sizeof(line), "culling: %d shapes drawn, %d subtrees skipped", cullStats.shapesDrawn,
+             cullStats.subtreesSkipped);
+    oLines.push_back(line);
+    if (settings.parallelPropagation)
+    {
+        snprintf(line, sizeof(line), "propagation: %d threads, grain %d", taskPool.GetThreadCount(),
+                 settings.propagationGrain);
+        oLines.push_back(line);
+    }
+}
+
+void SceneRenderer::InvalidateHierarchy()
+{
+    hierarchy.Invalidate();
+    spatialIndex.Clear();
+}
+
+void SceneRenderer::TraversalDraw(Node* iNodePtr)
+{
+    // The bounds are cached in the node like its world matrix, so an idle
+    // scene recomputes neither. Nothing below a subtree outside the view is visited.
+    if (settings.cullToView && !iNodePtr->GetSubtreeBounds().Intersects(viewBounds))
+    {
+        cullStats.subtreesSkipped += !iNodePtr->GetSubtreeBounds().IsEmpty();
+        return;
+    }
+    const Affine2x3& T = iNodePtr->GetWorldTransformation();
+    for (Node* p = iNodePtr->GetFirstChild(); p != nullptr; p = p->GetNextSibling())
+    {
+        TraversalDraw(p);
+    }
+
+    if (GetGeometry(iNodePtr->GetGeoId()) != nullptr &&
+        (!settings.cullToView || iNodePtr->GetGeometryWorldBounds().Intersects(viewBounds)))
+    {
+        cullStats.shapesDrawn++;
+        QueueDraw(iNodePtr->GetGeoId(), T, iNodePtr->GetColor());
+    }
+}
+
+void SceneRenderer::FlatDraw(Node& iRoot)
+{
+    PrepareHierarchy(iRoot);
+
+    const std::vector<int>* drawOrderPtr = &hierarchy.GetDrawOrder();
+    if (settings.cullToView)
+    {
+        ProfileScope scope(profiler, "cull");
+        UpdateBounds();
+        cullStats.subtreesSkipped = hierarchy.CullDrawOrder(viewBounds, visibleOrder);
+        drawOrderPtr = &visibleOrder;
+    }
+    const std::vector<int>& drawOrder = *drawOrderPtr;
+    cullStats.shapesDrawn = static_cast<int>(drawOrder.size());
+    if (settings.useInstancing)
+    {
+        ProfileScope scope(profiler, "InstancedDraw", PROFILE_CPU_GPU);
+        InstancedDraw(drawOrder);
+        return;
+    }
+    ProfileScope scope(profiler, "queue");
+    for (std::vector<int>::const_iterator p = drawOrder.begin(); p != drawOrder.end(); p++)
+    {
+        QueueDraw(hierarchy.geoId[*p], hierarchy.worldMat[*p], hierarchy.color[*p]);
+    }
+}
+
+void SceneRenderer::PrepareHierarchy(Node& iRoot)
+{
+    if (!hierarchy.IsCompiled())
+    {
+        ProfileScope scope(profiler, "compile");
+        hierarchy.Compile(iRoot, settings.fuseChains);
+        // The entries are numbered anew.
+        spatialIndex.Clear();
+    }
+    // A single linear pass over the arrays instead of a pointer-chasing recursion,
+    // or that pass cut into subtree ranges for the task pool.
+    ProfileScope scope(profiler, "propagate");
+    if (settings.parallelPropagation)
+    {
+        if (settings.propagationThreads != taskPoolThreads)
+        {
+            taskPool.SetThreadCount(settings.propagationThreads);
+            taskPoolThreads = settings.propagationThreads;
+        }
+        hierarchy.PropagateParallel(taskPool, settings.propagationGrain);
+    }
+    else
+    {
+        hierarchy.Propagate();
+    }
+}
+
+void SceneRenderer::UpdateBounds()
+{
+    // Only entries that moved since the last call, and their ancestors, get
+    // new bounds; the index refits the boxes above the shapes among them, or
+    // rebuilds when too many moved.
+    hierarchy.UpdateBounds();
+    if (spatialIndex.IsBuilt())
+    {
+        spatialIndex.Update(hierarchy.geoBounds, hierarchy.GetMovedShapes());
+    }
+}
+
+void SceneRenderer::PrepareSpatialIndex(Node& iRoot)
+{
+    PrepareHierarchy(iRoot);
+    UpdateBounds();
+    if (!spatialIndex.IsBuilt())
+    {
+        const std::vector<int>& drawOrder = hierarchy.GetDrawOrder();
+        spatialIndex.Build(hierarchy.geoBounds, drawOrder);
+        drawRank.assign(hierarchy.Size(), -1);
+        for (int k = 0; k < static_cast<int>(drawOrder.size()); k++)
+        {
+            drawRank[drawOrder[k]] = k;
+        }
+    }
+}
+
+// Whether iPoint lies in the shape drawn with iWorld. The shapes are those
+// built in src/scene/polygon.cpp, tested in their local coordinates.
+static bool ShapeContains(GeometryId iGeoId, const Affine2x3& iWorld, glm::vec2 iPoint)
+{
+    const float* m = iWorld.m;
+    float det = m[0] * m[3] - m[2] * m[1];
+    if (det == 0.f)
+    {
+        return false;
+    }
+    glm::vec2 q(iPoint.x - m[4], iPoint.y - m[5]);
+    glm::vec2 local((m[3] * q.x - m[2] * q.y) / det, (m[0] * q.y - m[1] * q.x) / det);
+    const Aabb2& box = GetGeometryBounds(iGeoId);
+    if (!(box.min.x <= local.x && local.x <= box.max.x && box.min.y <= local.y && local.y <= box.max.y))
+    {
+        return false;
+    }
+    switch (iGeoId)
+    {
+        case GEO_CIRCLE: // Radius 0.5
+            return local.x * local.x + local.y * local.y <= 0.25f;
+        case GEO_TRAPEZOID: // Half as wide at y 0.5 as at y -0.5; the box holds the other two sides
+            return std::fabs(local.x) <= 0.75f - 0.5f * local.y;
+        case GEO_SHOE: // The box without its upper right quarter
+            return local.x <= 0.f || local.y <= 0.f;
+    }
+    return true;
+}
+
+Node* SceneRenderer::PickNode(Node& iRoot, glm::vec2 iPoint)
+{
+    PrepareSpatialIndex(iRoot);
+    spatialIndex.QueryPoint(iPoint, queryItems);
+    int topmost = -1;
+    for (int entry : queryItems)
+    {
+        if ((topmost < 0 || drawRank[entry] > drawRank[topmost]) &&
+            ShapeContains(hierarchy.geoId[entry], hierarchy.worldMat[entry], iPoint))
+        {
+            topmost = entry;
+        }
+    }
+    return topmost >= 0 ? hierarchy.nodePtr[topmost] : nullptr;
+}
+
+void SceneRenderer::FindNodes(Node& iRoot, const Aabb2& iRect, std::vector<Node*>& oNodes)
+{
+    PrepareSpatialIndex(iRoot);
+    spatialIndex.QueryRect(iRect, queryItems);
+    std::sort(queryItems.begin(), queryItems.end(), [this](int a, int b) { return drawRank[a] < drawRank[b]; });
+    oNodes.clear();
+    for (int entry : queryItems)
+    {
+        oNodes.push_back(hierarchy.nodePtr[entry]);
+    }
+}
+
+void SceneRenderer::FindNearestNodes(Node& iRoot, glm::vec2 iPoint, int iCount, std::vector<Node*>& oNodes)
+{
+    PrepareSpatialIndex(iRoot);
+    spatialIndex.QueryNearest(iPoint, iCount, queryItems);
+    oNodes.clear();
+    for (int entry : queryItems)
+    {
+        oNodes.push_back(hierarchy.nodePtr[entry]);
+    }
+}
+
+glm::vec2 SceneRenderer::ClipToWorld(glm::vec2 iClip) const
+{
+    const float* m = inverseView.m;
+    return glm::vec2(m[0] * iClip.x + m[2] * iClip.y + m[4], m[1] * iClip.x + m[3] * iClip.y + m[5]);
+}
+
+void SceneRenderer::QueueDraw(GeometryId iGeoId, const Affine2x3& iWorld, const glm::vec3& iColor)
+{
+    // The depth field is the position in the walk, so equal state keeps the walk's order.
+    std::uint32_t item = static_cast<std::uint32_t>(queuedDraws.size());
+    QueuedDraw draw = {&iWorld, iColor};
+    queuedDraws.push_back(draw);
+    renderQueue.Push(RenderQueue::MakeKey(RENDER_LAYER_SCENE, RENDER_PROGRAM_FLAT, iGeoId, item), item);
+}
+
+void SceneRenderer::SubmitQueue()
+{
+    renderQueue.Sort();
+    const std::vector<DrawPacket>& packets = renderQueue.GetPackets();
+    if (packets.empty())
+    {
+        return;
+    }
+
+    // Sorting by state reorders overlapping shapes. The depth test restores
+    // what painting them in walk order would have shown: each draw gets a
+    // depth from its depth field, later draws nearer.
+    mp_context->glEnable(GL_DEPTH_TEST);
+    mp_context->glDepthFunc(GL_LESS);
+    double depthStep = 2.0 / (packets.size() + 1);
+    std::uint64_t boundState = ~std::uint64_t(0);
+    const ArenaMesh* mesh = nullptr;
+    // Every shape is in the arena: one bind for the whole queue, and a change
+    // of geometry only picks another index range.
+    prog_flat.bindArena(geometryArena);
+    for (std::vector<DrawPacket>::const_iterator p = packets.begin(); p != packets.end(); p++)
+    {
+        std::uint64_t state = RenderQueue::GetState(p->key);
+        if (state != boundState)
+        {
+            // prog_flat is the only queued program so far, so a new state means new geometry.
+            mesh = &GetGeometry(RenderQueue::GetGeometry(p->key))->mesh();
+            boundState = state;
+        }
+        const QueuedDraw& draw = queuedDraws[p->item];
+        prog_flat.setModelMatrix(*draw.world);
+        prog_flat.setColor(draw.color);
+        prog_flat.setDepth(float(1.0 - (RenderQueue::GetDepth(p->key) + 1.0) * depthStep));
+        prog_flat.drawMesh(*mp_context, *mesh);
+    }
+    prog_flat.unbindDrawable();
+    mp_context->glDisable(GL_DEPTH_TEST);
+
+    mp_context->checkGL("SceneRenderer::SubmitQueue");
+}
+
+void SceneRenderer::InstancedDraw(const std::vector<int>& iDrawOrder)
+{
+    // Count the instances of every shape, so the records can be written
+    // straight into one array grouped by shape.
+    int shapeStart[GEO_COUNT + 1] = {0};
+    for (std::vector<int>::const_iterator p = iDrawOrder.begin(); p != iDrawOrder.end(); p++)
+    {
+        shapeStart[hierarchy.geoId[*p] + 1]++;
+    }
+    for (int g = 0; g < GEO_COUNT; g++)
+    {
+        shapeStart[g + 1] += shapeStart[g];
+    }
+    int total = shapeStart[GEO_COUNT];
+    instanceTexels.resize(size_t(total) * InstanceBuffer::TEXELS_PER_INSTANCE);
+
+    // Grouping by shape changes the order the nodes are drawn in, so each
+    // gets a depth instead: later in iDrawOrder is nearer, exactly as if they
+    // had been painted one by one. A 24-bit depth buffer tells about 16M
+    // instances apart.
+    int next[GEO_COUNT];
+    std::copy(shapeStart, shapeStart + GEO_COUNT, next);
+    double depthStep = 2.0 / (total + 1);
+    int sequence = 0;
+    for (std::vector<int>::const_iterator p = iDrawOrder.begin(); p != iDrawOrder.end(); p++)
+    {
+        const Affine2x3& world = hierarchy.worldMat[*p];
+        float depth = float(1.0 - ++sequence * depthStep);
+        glm::vec4* record = &instanceTexels[size_t(next[hierarchy.geoId[*p]]++) * InstanceBuffer::TEXELS_PER_INSTANCE];
+        record[0] = glm::vec4(world.m[0], world.m[1], world.m[2], world.m[3]);
+        record[1] = glm::vec4(world.m[4], world.m[5], depth, 0.f);
+        record[2] = glm::vec4(hierarchy.color[*p], 0.f);
+    }
+
+    // Usually all records go up in one upload and every shape is one call
+    // into it. Should they not fit into one texture buffer, they are uploaded
+    // in windows and a shape that straddles two takes two calls.
+    mp_context->glEnable(GL_DEPTH_TEST);
+    mp_context->glDepthFunc(GL_LESS);
+    prog_instanced.bindArena(geometryArena);
+    int maxInstances = instanceBuffer.maxInstances();
+    int windowBegin = 0;
+    int windowEnd = 0;
+    for (GeometryId g = 0; g < GEO_COUNT; g++)
+    {
+        Polygon2D* geoPtr = GetGeometry(g);
+        int first = shapeStart[g];
+        int end = shapeStart[g + 1];
+        while (geoPtr != nullptr && first < end)
+        {
+            if (first >= windowEnd)
+            {
+                windowBegin = first;
+                windowEnd = std::min(total, first + maxInstances);
+                instanceBuffer.upload(&instanceTexels[size_t(first) * InstanceBuffer::TEXELS_PER_INSTANCE], windowEnd - windowBegin);
+                instanceBuffer.bind(0);
+            }
+            int count = std::min(end, windowEnd) - first;
+            prog_instanced.drawMeshInstanced(*mp_context, geoPtr->mesh(), first - windowBegin, count);
+            first += count;
+        }
+    }
+    prog_instanced.unbindDrawable();
+    mp_context->glDisable(GL_DEPTH_TEST);
+}
+
+Polygon2D* SceneRenderer::GetGeometry(GeometryId iGeoId)
+{
+    return iGeoId < GEO_COUNT ? geometryTable[iGeoId] : nullptr;
+}
+
+int SceneRenderer::GetPropagationThreadCount() const
+{
+    return taskPool.GetThreadCount();
+}
+
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <glfunctions.h>
+#include <shaderprogram.h>
+#include <scene/grid.h>
+#include <scene/polygon.h>
+#include "geometryarena.h"
+#include "gputimer.h"
+#include "instancebuffer.h"
+
+#include "frameprofiler.h"
+#include "node.h"
+#include "renderqueue.h"
+#include "smartpointerhelp.h"
+#include "spatialindex.h"
+#include "taskpool.h"
+#include "transformhierarchy.h"
+
+#include <string>
+#include <vector>
+
+// What a queued draw needs besides the state in its sort key.
+struct QueuedDraw
+{
+    const Affine2x3* world;
+    glm::vec3 color;
+};
+
+// What view culling left of the last frame.
+struct CullStats
+{
+    int shapesDrawn = 0;
+    int subtreesSkipped = 0;
+};
+
+// How SceneRenderer draws; MyGL toggles these from the keyboard. The
+// propagation's thread count and grain start from the environment variables
+// SCENEGRAPH_PROPAGATION_THREADS and SCENEGRAPH_PROPAGATION_GRAIN, if set.
+struct RenderSettings
+{
+    bool showGrid = true; // Draw the 5x5 grid behind the scene.
+    bool useFlatHierarchy = true; // Draw from the compiled TransformHierarchy instead of the recursive TraversalDraw.
+    bool fuseChains = true; // Compile the hierarchy with non-branching T/R/S runs folded into single entries.
+    bool parallelPropagation = true; // Propagate the hierarchy's world transforms on taskPool.
+    int propagationThreads = 0; // Threads of taskPool, the drawing one included; 0 uses every hardware thread.
+    int propagationGrain = 4096; // Entries per propagation task; smaller hierarchies are propagated on this thread.
+    bool useInstancing = true; // FlatDraw issues one instanced draw per shape instead of one draw per node.
+    bool cullToView = true; // Skip shapes, and whole subtrees, whose bounds lie outside the view.
+};
+
+// Everything needed to draw a scene graph with GL: shaders, shapes, the
+// compiled hierarchy and the render queue. It needs no widget, only current
+// GL functions, so MyGL and the headless benchmark (headless.h) share it.
+class SceneRenderer
+{
+private:
+    ShaderProgram prog_flat;// A shader program that uses "flat" reflection (no shadowing at all)
+    ShaderProgram prog_instanced; // prog_flat for many instances per draw call, reading them from instanceBuffer
+
+    Grid m_geomGrid;        // The instance of the object used to render the 5x5 grid
+    Polygon2D m_geomSquare; // The singular instance of our square object that can be re-drawn with different colors
+                            // to create the appearance of there being multiple squares
+
+    TransformHierarchy hierarchy; // Flattened copy of the drawn tree, recompiled when its structure changes.
+    TaskPool taskPool; // Worker threads for the parallel propagation.
+    int taskPoolThreads = 0; // The settings.propagationThreads taskPool was started with.
+
+    uPtr<RectangleGeometry> geoRectangle;
+    uPtr<CircleGeometry> geoCircle;
+    uPtr<TrapezoidGeometry> geoTrapezoid;
+    uPtr<ShoeGeometry> geoShoe;
+    Polygon2D* geometryTable[GEO_COUNT]; // Indexed by the GeometryId stored in the nodes.
+    GeometryArena geometryArena; // Holds the vertices and indices of every shape in geometryTable.
+
+    InstanceBuffer instanceBuffer; // Per-instance transforms and colors for prog_instanced.
+    std::vector<glm::vec4> instanceTexels; // This frame's records, grouped by shape; kept to reuse the memory.
+
+    RenderQueue renderQueue; // This frame's per-node draws, sorted by state before they are submitted.
+    std::vector<QueuedDraw> queuedDraws; // Indexed by DrawPacket::item.
+
+    // World bounds of the hierarchy's shapes, for picking and region queries.
+    // Built by the first query after a compile, then refitted whenever the
+    // bounds are updated.
+    SpatialIndex spatialIndex;
+    std::vector<int> drawRank; // Position of each entry in the draw order, so picking finds the topmost shape.
+    std::vector<int> queryItems; // Scratch for the entries found by a query.
+
+    Affine2x3 inverseView; // Clip space to world, set by UpdateView().
+    Aabb2 viewBounds; // The part of the world the view shows, set by UpdateView().
+    std::vector<int> visibleOrder; // This frame's draw order of the flat hierarchy after culling.
+    CullStats cullStats; // This frame's culling.
+
+    GpuTimer gpuTimer; // GPU times of the profiler's PROFILE_CPU_GPU scopes, if the context has timer queries.
+
+    GLFunctions* mp_context;
+
+public:
+    RenderSettings settings;
+    // Off until someone wants its results. The owner of the frame loop calls
+    // profiler.EndFrame() after each frame.
+    FrameProfiler profiler;
+
+    SceneRenderer(GLFunctions* context);
+
+    // Create the shaders and shapes. The GL functions must be initialized and current.
+    void Initialize();
+    void Destroy();
+    // Upload the view matrix and derive the culling bounds from it; the screen always shows -5 to 5.
+    void UpdateView();
+    // Draw the tree under iRoot into the bound framebuffer.
+    void RenderFrame(Node& iRoot);
+    // The upload, state call, queue and culling counters of the last frame,
+    // one line each, for the profiler overlay.
+    void DescribeFrameStats(std::vector<std::string>& oLines) const;
+    // The tree's structure changed or another tree is drawn from now on.
+    void InvalidateHierarchy();
+
+    // Queries over the shapes of the tree under iRoot, in world coordinates.
+    // Each first brings the hierarchy and its spatial index up to date.
+    // PickNode() returns the topmost node whose shape contains iPoint, or nullptr.
+    Node* PickNode(Node& iRoot, glm::vec2 iPoint);
+    // The nodes whose shape's bounds intersect iRect, in draw order.
+    void FindNodes(Node& iRoot, const Aabb2& iRect, std::vector<Node*>& oNodes);
+    // The iCount nodes whose shape's bounds are nearest to iPoint, nearest first.
+    void FindNearestNodes(Node& iRoot, glm::vec2 iPoint, int iCount, std::vector<Node*>& oNodes);
+    // Where a point of the -1 to 1 clip square lies in the world.
+    glm::vec2 ClipToWorld(glm::vec2 iClip) const;
+
+    Polygon2D* GetGeometry(GeometryId iGeoId);
+    // Threads the parallel propagation runs on, as settings.propagationThreads resolved when it last ran.
+    int GetPropagationThreadCount() const;
+
+    // Both walks only queue their draws; SubmitQueue() issues them.
+    void TraversalDraw(Node* iNodePtr);
+    void FlatDraw(Node& iRoot);
+    void QueueDraw(GeometryId iGeoId, const Affine2x3& iWorld, const glm::vec3& iColor);
+    // Sort the queued draws by state and issue them, binding only when the state changes.
+    void SubmitQueue();
+    // Draw the nodes in iDrawOrder with one instanced call per shape.
+    void InstancedDraw(const std::vector<int>& iDrawOrder);
+
+private:
+    // Compile the hierarchy if it is stale and propagate its world transforms.
+    void PrepareHierarchy(Node& iRoot);
+    // Update the bounds of what moved and refit the spatial index, if built, to them.
+    void UpdateBounds();
+    // PrepareHierarchy() and UpdateBounds(), then build the spatial index if there is none.
+    void PrepareSpatialIndex(Node& iRoot);
+};
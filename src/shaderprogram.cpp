@@ -1,11 +1,15 @@
 #include "shaderprogram.h"
 #include <QFile>
+#include <cstring>
 
 
-ShaderProgram::ShaderProgram(OpenGLContext *context)
+ShaderProgram::ShaderProgram(GLFunctions *context)
     : m_vertShader(), m_fragShader(), m_prog(),
       m_attrPos(-1), m_attrCol(-1),
-      m_unifModel(-1), m_unifView(-1),
+      m_unifModel(-1), m_unifView(-1), m_unifColor(-1), m_unifDepth(-1),
+      m_unifInstances(-1), m_unifInstanceBase(-1),
+      m_uniformsSet(0), m_lastModel(), m_lastView(), m_lastColor(), m_lastDepth(0.f),
+      m_lastInstanceUnit(0), m_lastInstanceBase(0),
       context(context)
 {}
 
@@ -45,6 +49,9 @@ void ShaderProgram::create(const char *vertfile, const char *fragfile)
     // Tell prog that it manages these particular vertex and fragment shaders
     context->glAttachShader(m_prog, m_vertShader);
     context->glAttachShader(m_prog, m_fragShader);
+    // Fixed attribute locations, so the VAOs of the Drawables fit every program.
+    context->glBindAttribLocation(m_prog, ATTR_POS, "vs_Pos");
+    context->glBindAttribLocation(m_prog, ATTR_COL, "vs_Col");
     context->glLinkProgram(m_prog);
 
     // Check for linking success
@@ -62,6 +69,24 @@ void ShaderProgram::create(const char *vertfile, const char *fragfile)
 
     m_unifModel      = context->glGetUniformLocation(m_prog, "u_Model");
     m_unifView   = context->glGetUniformLocation(m_prog, "u_View");
+    m_unifColor = context->glGetUniformLocation(m_prog, "u_Color");
+    m_unifDepth = context->glGetUniformLocation(m_prog, "u_Depth");
+    m_unifInstances = context->glGetUniformLocation(m_prog, "u_Instances");
+    m_unifInstanceBase = context->glGetUniformLocation(m_prog, "u_InstanceBase");
+}
+
+template<typename T>
+bool ShaderProgram::uniformChanged(T &last, const T &value, unsigned int bit)
+{
+    // Compared bytewise; a value that only looks different (0 and -0) is merely sent again.
+    bool changed = (m_uniformsSet & bit) == 0 || std::memcmp(&last, &value, sizeof(T)) != 0;
+    if (changed)
+    {
+        last = value;
+        m_uniformsSet |= bit;
+    }
+    context->countUniform(changed);
+    return changed;
 }
 
 void ShaderProgram::useMe()
@@ -69,74 +94,140 @@ void ShaderProgram::useMe()
     context->glUseProgram(m_prog);
 }
 
-void ShaderProgram::setModelMatrix(const glm::mat3 &model)
+void ShaderProgram::setModelMatrix(const Affine2x3 &model)
 {
     useMe();
 
-    if (m_unifModel != -1)
+    if (m_unifModel != -1 && uniformChanged(m_lastModel, model, UNIFORM_MODEL))
     {
-        // Pass a 3x3 matrix into a uniform variable in our shader
+        // Pass a 2x3 affine matrix into a uniform mat3x2 in our shader;
+        // the constant bottom row (0, 0, 1) is never sent.
                         // Handle to the matrix variable on the GPU
-        context->glUniformMatrix3fv(m_unifModel,
+        context->glUniformMatrix3x2fv(m_unifModel,
                         // How many matrices to pass
                            1,
                         // Transpose the matrix? OpenGL uses column-major, so no.
                            GL_FALSE,
                         // Pointer to the first element of the matrix
-                           &model[0][0]);
+                           model.m);
     }
 }
 
-void ShaderProgram::setViewMatrix(const glm::mat3 &vp)
+void ShaderProgram::setViewMatrix(const Affine2x3 &vp)
 {
     // Tell OpenGL to use this shader program for subsequent function calls
     useMe();
 
-    if (m_unifView != -1)
+    if (m_unifView != -1 && uniformChanged(m_lastView, vp, UNIFORM_VIEW))
     {
-    // Pass a 3x3 matrix into a uniform variable in our shader
-                    // Handle to the matrix variable on the GPU
-    context->glUniformMatrix3fv(m_unifView,
-                    // How many matrices to pass
-                       1,
-                    // Transpose the matrix? OpenGL uses column-major, so no.
-                       GL_FALSE,
-                    // Pointer to the first element of the matrix
-                       &vp[0][0]);
+        // Pass a 2x3 affine matrix into a uniform mat3x2 in our shader
+                        // Handle to the matrix variable on the GPU
+        context->glUniformMatrix3x2fv(m_unifView,
+                        // How many matrices to pass
+                           1,
+                        // Transpose the matrix? OpenGL uses column-major, so no.
+                           GL_FALSE,
+                        // Pointer to the first element of the matrix
+                           vp.m);
     }
 }
 
-//This function, as its name implies, uses the passed in GL widget
-void ShaderProgram::draw(OpenGLContext &f, Drawable &d)
+void ShaderProgram::setColor(const glm::vec3 &color)
 {
     useMe();
 
-    // Each of the following blocks checks that:
-    //   * This shader has this attribute, and
-    //   * This Drawable has a vertex buffer for this attribute.
-    // If so, it binds the appropriate buffers to each attribute.
+    if (m_unifColor != -1 && uniformChanged(m_lastColor, color, UNIFORM_COLOR))
+    {
+        context->glUniform3fv(m_unifColor, 1, &color[0]);
+    }
+}
+
+void ShaderProgram::setDepth(float depth)
+{
+    useMe();
 
-    if (m_attrPos != -1 && d.bindPos())
+    if (m_unifDepth != -1 && uniformChanged(m_lastDepth, depth, UNIFORM_DEPTH))
     {
-        context->glEnableVertexAttribArray(m_attrPos);
-        context->glVertexAttribPointer(m_attrPos, 3, GL_FLOAT, false, 0, NULL);
+        context->glUniform1f(m_unifDepth, depth);
     }
+}
+
+void ShaderProgram::setInstanceUnit(int unit)
+{
+    useMe();
+
+    if (m_unifInstances != -1 && uniformChanged(m_lastInstanceUnit, unit, UNIFORM_INSTANCE_UNIT))
+    {
+        context->glUniform1i(m_unifInstances, unit);
+    }
+}
+
+//This function, as its name implies, uses the passed in GL widget
+void ShaderProgram::draw(GLFunctions &f, Drawable &d)
+{
+    bindDrawable(d);
+    drawBound(f, d);
+    unbindDrawable();
+
+    f.checkGL("ShaderProgram::draw");
+}
+
+void ShaderProgram::bindDrawable(Drawable &d)
+{
+    useMe();
 
-    if (m_attrCol != -1 && d.bindCol())
+    // The Drawable's VAO already holds its buffers, attribute pointers and index buffer.
+    d.bindVao();
+    if (m_attrCol != -1 && !d.hasCol())
     {
-        context->glEnableVertexAttribArray(m_attrCol);
-        context->glVertexAttribPointer(m_attrCol, 3, GL_FLOAT, false, 0, NULL);
+        // No per-vertex colors: the attribute reads this constant instead and
+        // the color comes from u_Color alone.
+        context->glVertexAttrib3f(ATTR_COL, 1.f, 1.f, 1.f);
     }
+}
 
-    // Bind the index buffer and then draw shapes from it.
+void ShaderProgram::drawBound(GLFunctions &f, Drawable &d)
+{
     // This invokes the shader program, which accesses the vertex buffers.
-    d.bindIdx();
     f.glDrawElements(d.drawMode(), d.elemCount(), GL_UNSIGNED_INT, 0);
+}
 
-    if (m_attrPos != -1) context->glDisableVertexAttribArray(m_attrPos);
-    if (m_attrCol != -1) context->glDisableVertexAttribArray(m_attrCol);
+void ShaderProgram::unbindDrawable()
+{
+    // Buffer uploads must not change the VAO of what was drawn.
+    context->glBindVertexArray(0);
+}
 
-    f.printGLErrorLog();
+void ShaderProgram::bindArena(GeometryArena &arena)
+{
+    useMe();
+
+    arena.bind();
+    if (m_attrCol != -1)
+    {
+        // Arena meshes have no per-vertex colors, see bindDrawable().
+        context->glVertexAttrib3f(ATTR_COL, 1.f, 1.f, 1.f);
+    }
+}
+
+void ShaderProgram::drawMesh(GLFunctions &f, const ArenaMesh &mesh)
+{
+    f.glDrawElementsBaseVertex(mesh.mode, mesh.indexCount, GL_UNSIGNED_INT,
+                               reinterpret_cast<const void*>(mesh.indexOffset), mesh.baseVertex);
+    f.checkGL("ShaderProgram::drawMesh");
+}
+
+void ShaderProgram::drawMeshInstanced(GLFunctions &f, const ArenaMesh &mesh, int first, int count)
+{
+    useMe();
+
+    if (m_unifInstanceBase != -1 && uniformChanged(m_lastInstanceBase, first, UNIFORM_INSTANCE_BASE))
+    {
+        context->glUniform1i(m_unifInstanceBase, first);
+    }
+    f.glDrawElementsInstancedBaseVertex(mesh.mode, mesh.indexCount, GL_UNSIGNED_INT,
+                                        reinterpret_cast<const void*>(mesh.indexOffset), count, mesh.baseVertex);
+    f.checkGL("ShaderProgram::drawMeshInstanced");
 }
 
 char* ShaderProgram::textFileRead(const char* fileName) {
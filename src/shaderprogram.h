@@ -1,12 +1,14 @@
 #pragma once
 
-#include <openglcontext.h>
+#include <glfunctions.h>
 #include <la.h>
 #include <glm/glm.hpp>
+#include "affine2x3.h"
 
 #include <QOpenGLFunctions_3_2_Core>
 #include <QOpenGLShaderProgram>
 #include "drawable.h"
+#include "geometryarena.h"
 
 
 class ShaderProgram
@@ -16,24 +18,47 @@ public:
     GLuint m_fragShader; // A handle for the fragment shader stored in this shader program
     GLuint m_prog;       // A handle for the linked shader program stored in this class
 
-    int m_attrPos; // A handle for the "in" vec3 representing vertex position in the vertex shader
-    int m_attrCol; // A handle for the "in" vec3 representing vertex color in the vertex shader
+    int m_attrPos; // A handle for the "in" vec3 representing vertex position in the vertex shader; ATTR_POS or -1
+    int m_attrCol; // A handle for the "in" vec3 representing vertex color in the vertex shader; ATTR_COL or -1
 
-    int m_unifModel; // A handle for the "uniform" mat3 representing model matrix in the vertex shader
-    int m_unifView; // A handle for the "uniform" mat3 representing the matrix used to scale geometry to the desired size in the vertex shader
+    int m_unifModel; // A handle for the "uniform" mat3x2 representing model matrix in the vertex shader
+    int m_unifView; // A handle for the "uniform" mat3x2 representing the matrix used to scale geometry to the desired size in the vertex shader
+    int m_unifColor; // A handle for the "uniform" vec3 that tints the vertex colors in the vertex shader
+    int m_unifDepth; // A handle for the "uniform" float giving the depth of what is drawn in the vertex shader
+    int m_unifInstances; // A handle for the "uniform" samplerBuffer holding per-instance data in instanced shaders
+    int m_unifInstanceBase; // A handle for the "uniform" int giving the record of the first instance of a draw
 
 public:
-    ShaderProgram(OpenGLContext* context);
+    ShaderProgram(GLFunctions* context);
     // Sets up the requisite GL data and shaders from the given .glsl files
     void create(const char *vertfile, const char *fragfile);
-    // Tells our OpenGL context to use this shader to draw things
+    // Tells our OpenGL context to use this shader to draw things. Cheap when it
+    // already is in use: GLFunctions drops the redundant glUseProgram.
     void useMe();
     // Pass the given model matrix to this shader on the GPU
-    void setModelMatrix(const glm::mat3 &model);
+    void setModelMatrix(const Affine2x3 &model);
     // Pass the given Projection * View matrix to this shader on the GPU
-    void setViewMatrix(const glm::mat3 &vp);
+    void setViewMatrix(const Affine2x3 &vp);
+    // Pass the color of the node about to be drawn; it is multiplied with the per-vertex colors
+    void setColor(const glm::vec3 &color);
+    // Pass the depth of the next draws, in [-1, 1]; only matters while the depth test is on
+    void setDepth(float depth);
+    // Tell an instanced shader which texture unit holds its InstanceBuffer
+    void setInstanceUnit(int unit);
     // Draw the given object to our screen using this ShaderProgram's shaders
-    void draw(OpenGLContext &f, Drawable &d);
+    void draw(GLFunctions &f, Drawable &d);
+    // draw() in three steps, for many draws of the same object: bind its VAO
+    // once, draw it as often as needed, then unbind the VAO again
+    void bindDrawable(Drawable &d);
+    void drawBound(GLFunctions &f, Drawable &d);
+    void unbindDrawable();
+    // Bind the VAO of a GeometryArena; any of its meshes can then be drawn without
+    // binding anything else. unbindDrawable() unbinds it again.
+    void bindArena(GeometryArena &arena);
+    void drawMesh(GLFunctions &f, const ArenaMesh &mesh);
+    // Draw count instances of the given mesh in one call, starting at record first of the
+    // bound InstanceBuffer; the shader fetches the per-instance data
+    void drawMeshInstanced(GLFunctions &f, const ArenaMesh &mesh, int first, int count);
     // Utility function used in create()
     char* textFileRead(const char*);
     // Utility function used in create()
@@ -44,7 +69,32 @@ public:
     void printLinkInfoLog(int prog);
 
 private:
-    OpenGLContext* context;   // Since Qt's OpenGL support is done through classes like QOpenGLFunctions_3_2_Core,
+    // Whether value differs from what was last sent to the uniform the bit stands for.
+    // If so it is remembered as sent; either way the context counts the call.
+    template<typename T>
+    bool uniformChanged(T &last, const T &value, unsigned int bit);
+
+    enum UniformBit
+    {
+        UNIFORM_MODEL = 1 << 0,
+        UNIFORM_VIEW = 1 << 1,
+        UNIFORM_COLOR = 1 << 2,
+        UNIFORM_DEPTH = 1 << 3,
+        UNIFORM_INSTANCE_UNIT = 1 << 4,
+        UNIFORM_INSTANCE_BASE = 1 << 5
+    };
+
+    // The values last sent to the uniforms, which keep them between draws and
+    // frames. A uniform is only sent when its value changes.
+    unsigned int m_uniformsSet; // UniformBits of the values below that were sent at all
+    Affine2x3 m_lastModel;
+    Affine2x3 m_lastView;
+    glm::vec3 m_lastColor;
+    float m_lastDepth;
+    int m_lastInstanceUnit;
+    int m_lastInstanceBase;
+
+    GLFunctions* context;   // Since Qt's OpenGL support is done through classes like QOpenGLFunctions_3_2_Core,
                             // we need to pass our OpenGL context to the Drawable in order to call GL functions
                             // from within this class.
 };
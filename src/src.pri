@@ -4,8 +4,14 @@ DEPENDPATH += $$PWD
 SOURCES += \
     $$PWD/main.cpp \
     $$PWD/mainwindow.cpp \
+    $$PWD/geometryarena.cpp \
+    $$PWD/glfunctions.cpp \
+    $$PWD/gputimer.cpp \
+    $$PWD/headless.cpp \
+    $$PWD/instancebuffer.cpp \
     $$PWD/mygl.cpp \
-    $$PWD/node.cpp \
+    $$PWD/nodeitem.cpp \
+    $$PWD/scenerenderer.cpp \
     $$PWD/shaderprogram.cpp \
     $$PWD/utils.cpp \
     $$PWD/la.cpp \
@@ -17,12 +23,17 @@ SOURCES += \
 HEADERS += \
     $$PWD/la.h \
     $$PWD/mainwindow.h \
+    $$PWD/geometryarena.h \
+    $$PWD/glfunctions.h \
+    $$PWD/gputimer.h \
+    $$PWD/headless.h \
+    $$PWD/instancebuffer.h \
     $$PWD/mygl.h \
-    $$PWD/node.h \
+    $$PWD/nodeitem.h \
+    $$PWD/scenerenderer.h \
     $$PWD/shaderprogram.h \
     $$PWD/utils.h \
     $$PWD/drawable.h \
     $$PWD/scene/grid.h \
     $$PWD/scene/polygon.h \
-    $$PWD/openglcontext.h \
-    $$PWD/smartpointerhelp.h
+    $$PWD/openglcontext.h